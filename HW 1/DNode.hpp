@@ -1,6 +1,8 @@
 #ifndef DNODE_HPP
 #define DNODE_HPP
 
+#include <utility>
+
 template <typename T>
 class DNode {
 public:
@@ -8,7 +10,9 @@ public:
     DNode<T>* prev;
     DNode<T>* next;
 
-    DNode(T data) : data(data), prev(nullptr), next(nullptr) {}
+    // Construct the value in place from whatever arguments T accepts (a T to copy or move, or ctor args).
+    template <typename... Args>
+    explicit DNode(Args&&... args) : data(std::forward<Args>(args)...), prev(nullptr), next(nullptr) {}
 };
 
 #endif // DNODE_HPP
@@ -1,8 +1,18 @@
 #ifndef DOUBLYLINKEDLIST_HPP
 #define DOUBLYLINKEDLIST_HPP
 
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "DNode.hpp"
 #include "DoublyLinkedListIterator.hpp"
+#include "ListAlgorithms.hpp"
+#include "NodePool.hpp"
 
 template <typename T>
 class DoublyLinkedList {
@@ -10,12 +20,95 @@ private:
     DNode<T>* head;
     DNode<T>* tail;
     int listSize;
+    std::shared_ptr<NodePool<DNode<T>>> pool; // nodes are recycled through the pool instead of new/delete
+    DNode<T>* finger; // last node reached by position, so sequential access continues from where it left off
+    int fingerIndex;
+
+    // Find the node at a valid index by walking from whichever of head, tail or finger is closest.
+    DNode<T>* NodeAt(int index) {
+        DNode<T>* current;
+        int distance;
+        int fromTail = listSize - 1 - index;
+        if (index <= fromTail) {
+            current = head;
+            distance = index;
+        }
+        else {
+            current = tail;
+            distance = -fromTail;
+        }
+        if (finger && std::abs(index - fingerIndex) < std::abs(distance)) {
+            current = finger;
+            distance = index - fingerIndex;
+        }
+        for (; distance > 0; distance--) {
+            current = current->next;
+        }
+        for (; distance < 0; distance++) {
+            current = current->prev;
+        }
+        finger = current;
+        fingerIndex = index;
+        return current;
+    }
+
+    // Detach all of other's elements as a chain of nodes owned by this list's pool. Nodes are relinked as-is when
+    // both lists share a pool; otherwise each value is moved into a node from this pool. other is left empty.
+    DNode<T>* TakeNodes(DoublyLinkedList& other, DNode<T>*& last) {
+        DNode<T>* first = nullptr;
+        last = nullptr;
+        if (other.pool == pool) {
+            first = other.head;
+            last = other.tail;
+            other.head = other.tail = other.finger = nullptr;
+            other.listSize = 0;
+            return first;
+        }
+        for (DNode<T>* current = other.head; current; current = current->next) {
+            DNode<T>* newNode = pool->Allocate(std::move(current->data));
+            newNode->prev = last;
+            if (last) {
+                last->next = newNode;
+            }
+            else {
+                first = newNode;
+            }
+            last = newNode;
+        }
+        other.Clear();
+        return first;
+    }
+
+    // Rebuild prev links and tail after the chain was relinked through next only.
+    void RelinkPrev() {
+        DNode<T>* prev = nullptr;
+        for (DNode<T>* current = head; current; current = current->next) {
+            current->prev = prev;
+            prev = current;
+        }
+        tail = prev;
+        finger = nullptr;
+    }
 
 public:
-    DoublyLinkedList() : head(nullptr), tail(nullptr), listSize(0) {}
+    DoublyLinkedList() : head(nullptr), tail(nullptr), listSize(0), pool(std::make_shared<NodePool<DNode<T>>>()), finger(nullptr), fingerIndex(0) {}
+
+    // Share a node pool with other lists of the same element type.
+    explicit DoublyLinkedList(std::shared_ptr<NodePool<DNode<T>>> pool) : head(nullptr), tail(nullptr), listSize(0), pool(pool), finger(nullptr), fingerIndex(0) {}
+
+    DoublyLinkedList(const DoublyLinkedList&) = delete;
+    DoublyLinkedList& operator=(const DoublyLinkedList&) = delete;
 
-    void Add(T& value) {
-        DNode<T>* newNode = new DNode<T>(value);
+    ~DoublyLinkedList() { Clear(); }
+
+    void Add(const T& value) { Emplace(value); }
+
+    void Add(T&& value) { Emplace(std::move(value)); }
+
+    // Construct a new last element in place from T's constructor arguments.
+    template <typename... Args>
+    T& Emplace(Args&&... args) {
+        DNode<T>* newNode = pool->Allocate(std::forward<Args>(args)...);
         if (!head) {
             head = tail = newNode;
         }
@@ -25,51 +118,49 @@ public:
             tail = newNode;
         }
         listSize++;
+        return newNode->data;
     }
 
-    void Insert(T& value, int index) {
+    void Insert(const T& value, int index) { EmplaceAt(index, value); }
+
+    void Insert(T&& value, int index) { EmplaceAt(index, std::move(value)); }
+
+    // Construct a new element in place so that it ends up at the given index.
+    template <typename... Args>
+    T& EmplaceAt(int index, Args&&... args) {
         if (index < 0 || index > listSize) {
             throw std::out_of_range("Index out of range");
         }
-        DNode<T>* newNode = new DNode<T>(value);
+        if (index == listSize) {
+            return Emplace(std::forward<Args>(args)...);
+        }
+        DNode<T>* newNode = pool->Allocate(std::forward<Args>(args)...);
         if (index == 0) {
             newNode->next = head;
-            if (head) {
-                head->prev = newNode;
-            }
+            head->prev = newNode;
             head = newNode;
-            if (!tail) {
-                tail = newNode;
-            }
-        }
-        else if (index == listSize) {
-            Add(value);
         }
         else {
-            DNode<T>* current = head;
-            for (int i = 0; i < index; i++) {
-                current = current->next;
-            }
+            DNode<T>* current = NodeAt(index);
             newNode->next = current;
             newNode->prev = current->prev;
             current->prev->next = newNode;
             current->prev = newNode;
         }
         listSize++;
+        finger = newNode;
+        fingerIndex = index;
+        return newNode->data;
     }
 
     T& Get(int index) {
         if (index < 0 || index >= listSize) {
             throw std::out_of_range("Index out of range");
         }
-        DNode<T>* current = head;
-        for (int i = 0; i < index; i++) {
-            current = current->next;
-        }
-        return current->data;
+        return NodeAt(index)->data;
     }
 
-    int IndexOf(T& value) {
+    int IndexOf(const T& value) {
         DNode<T>* current = head;
         int index = 0;
         while (current) {
@@ -82,37 +173,144 @@ public:
         return -1;
     }
 
-    T& Remove(int index) {
+    // Index of the last element equal to value, searching backwards from the tail.
+    int LastIndexOf(const T& value) {
+        DNode<T>* current = tail;
+        int index = listSize - 1;
+        while (current) {
+            if (current->data == value) {
+                return index;
+            }
+            current = current->prev;
+            index--;
+        }
+        return -1;
+    }
+
+    // Moves the removed value out to the caller; the node's storage goes straight back to the pool.
+    T Remove(int index) {
         if (index < 0 || index >= listSize) {
             throw std::out_of_range("Index out of range");
         }
-        DNode<T>* toRemove = head;
-        if (index == 0) {
-            head = head->next;
-            if (head) {
-                head->prev = nullptr;
-            }
+        DNode<T>* toRemove = NodeAt(index);
+        if (toRemove->prev) {
+            toRemove->prev->next = toRemove->next;
         }
         else {
-            for (int i = 0; i < index; i++) {
-                toRemove = toRemove->next;
-            }
-            toRemove->prev->next = toRemove->next;
-            if (toRemove->next) {
-                toRemove->next->prev = toRemove->prev;
-            }
-            else {
-                tail = toRemove->prev;
-            }
+            head = toRemove->next;
+        }
+        if (toRemove->next) {
+            toRemove->next->prev = toRemove->prev;
+        }
+        else {
+            tail = toRemove->prev;
         }
         listSize--;
-        T& data = toRemove->data;
-        delete toRemove;
+
+        // Keep the finger next to the removed node so removal loops stay sequential.
+        if (toRemove->next) {
+            finger = toRemove->next;
+        }
+        else {
+            finger = toRemove->prev;
+            fingerIndex = index - 1;
+        }
+        T data = std::move(toRemove->data);
+        pool->Release(toRemove);
         return data;
     }
 
+    // Remove every element. When no other list shares the pool, whole slabs are freed at once
+    // instead of recycling nodes one by one.
+    void Clear() {
+        if (pool.use_count() == 1) {
+            if (!std::is_trivially_destructible<T>::value) {
+                for (DNode<T>* current = head; current; current = current->next) {
+                    current->~DNode<T>();
+                }
+            }
+            pool->Reset();
+        }
+        else {
+            while (head) {
+                DNode<T>* next = head->next;
+                pool->Release(head);
+                head = next;
+            }
+        }
+        head = tail = finger = nullptr;
+        listSize = 0;
+    }
+
+    // Copy the elements into a contiguous vector.
+    std::vector<T> ToVector() const { return FlattenNodes(head, listSize); }
+
+    // Copy every element satisfying pred, in order, evaluating pred over up to `threads` segments concurrently.
+    template <typename Predicate>
+    std::vector<T> FindAll(Predicate pred, int threads = 1) const { return FindAllNodes(head, listSize, pred, threads); }
+
+    // Stable merge sort that relinks nodes; no element is copied or moved.
+    template <typename Compare = std::less<T>>
+    void Sort(Compare less = Compare()) {
+        head = MergeSortNodes(head, listSize, less);
+        RelinkPrev();
+    }
+
+    // Move all of other's elements into this list so they start at index. O(1) plus the nearest-end walk to
+    // index when both lists share a node pool.
+    void Splice(int index, DoublyLinkedList& other) {
+        if (index < 0 || index > listSize) {
+            throw std::out_of_range("Index out of range");
+        }
+        if (&other == this || other.listSize == 0) {
+            return;
+        }
+        DNode<T>* before = index == listSize ? tail : NodeAt(index)->prev;
+        int count = other.listSize;
+        DNode<T>* last;
+        DNode<T>* first = TakeNodes(other, last);
+        DNode<T>* after = before ? before->next : head;
+        first->prev = before;
+        last->next = after;
+        if (before) {
+            before->next = first;
+        }
+        else {
+            head = first;
+        }
+        if (after) {
+            after->prev = last;
+        }
+        else {
+            tail = last;
+        }
+        listSize += count;
+        finger = first;
+        fingerIndex = index;
+    }
+
+    // Append all of other's elements.
+    void Splice(DoublyLinkedList& other) { Splice(listSize, other); }
+
+    // Merge the sorted list other into this sorted list by relinking nodes; other is left empty.
+    template <typename Compare = std::less<T>>
+    void Merge(DoublyLinkedList& other, Compare less = Compare()) {
+        if (&other == this || other.listSize == 0) {
+            return;
+        }
+        int count = other.listSize;
+        DNode<T>* last;
+        DNode<T>* first = TakeNodes(other, last);
+        head = MergeNodes(head, first, less);
+        listSize += count;
+        RelinkPrev();
+    }
+
     int Size() const { return listSize; }
 
+    // Node pool backing this list, for sharing and allocation instrumentation.
+    std::shared_ptr<NodePool<DNode<T>>> Pool() const { return pool; }
+
     DoublyLinkedListIterator<T> Iterator() { return DoublyLinkedListIterator<T>(head); }
 };
 
@@ -0,0 +1,21 @@
+#ifndef INTRUSIVEHOOK_HPP
+#define INTRUSIVEHOOK_HPP
+
+// Links embedded in a user object so it can sit in an IntrusiveList without a separate node allocation.
+// Derive from IntrusiveHook<Tag> once per list the object should be able to join at the same time.
+template <typename Tag = void>
+class IntrusiveHook {
+public:
+    IntrusiveHook* prev;
+    IntrusiveHook* next;
+
+    IntrusiveHook() : prev(nullptr), next(nullptr) {}
+
+    // Copying an object never copies its membership in a list.
+    IntrusiveHook(const IntrusiveHook&) : prev(nullptr), next(nullptr) {}
+    IntrusiveHook& operator=(const IntrusiveHook&) { return *this; }
+
+    bool IsLinked() const { return next != nullptr; }
+};
+
+#endif // INTRUSIVEHOOK_HPP
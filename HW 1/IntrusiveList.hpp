@@ -0,0 +1,116 @@
+#ifndef INTRUSIVELIST_HPP
+#define INTRUSIVELIST_HPP
+
+#include <stdexcept>
+
+#include "IntrusiveHook.hpp"
+#include "IntrusiveListIterator.hpp"
+
+// Doubly linked list threaded through hooks that live inside the elements themselves.
+// The list never allocates or copies: it links the caller's objects, which must outlive their membership.
+template <typename T, typename Tag = void>
+class IntrusiveList {
+private:
+    typedef IntrusiveHook<Tag> Hook;
+
+    Hook sentinel; // circular list: sentinel.next is the head, sentinel.prev the tail
+    int listSize;
+
+    static Hook* HookOf(T& value) { return static_cast<Hook*>(&value); }
+    static T& Owner(Hook* hook) { return *static_cast<T*>(hook); }
+
+    void LinkBefore(Hook* position, Hook* hook) {
+        if (hook->IsLinked()) {
+            throw std::logic_error("Element is already linked");
+        }
+        hook->next = position;
+        hook->prev = position->prev;
+        position->prev->next = hook;
+        position->prev = hook;
+        listSize++;
+    }
+
+    void Unlink(Hook* hook) {
+        hook->prev->next = hook->next;
+        hook->next->prev = hook->prev;
+        hook->prev = hook->next = nullptr;
+        listSize--;
+    }
+
+public:
+    IntrusiveList() : listSize(0) { sentinel.prev = sentinel.next = &sentinel; }
+
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+    // Unlink every element so they can join another list after this one is gone.
+    ~IntrusiveList() { Clear(); }
+
+    void PushBack(T& value) { LinkBefore(&sentinel, HookOf(value)); }
+
+    void PushFront(T& value) { LinkBefore(sentinel.next, HookOf(value)); }
+
+    // Link value directly before position, which must already be in this list.
+    void InsertBefore(T& position, T& value) { LinkBefore(HookOf(position), HookOf(value)); }
+
+    // O(1): the element knows its own neighbours, so no search is needed.
+    // value must be in this list: one linked into another list is unlinked from it, but this list's size is decremented.
+    void Remove(T& value) {
+        if (!HookOf(value)->IsLinked()) {
+            throw std::logic_error("Element is not linked");
+        }
+        Unlink(HookOf(value));
+    }
+
+    T& PopFront() {
+        T& value = Front();
+        Unlink(sentinel.next);
+        return value;
+    }
+
+    T& PopBack() {
+        T& value = Back();
+        Unlink(sentinel.prev);
+        return value;
+    }
+
+    // Relink an element at the head, e.g. on access in an LRU cache. value must already be in this list.
+    void MoveToFront(T& value) {
+        Remove(value);
+        PushFront(value);
+    }
+
+    // Relink an element at the tail; value must already be in this list.
+    void MoveToBack(T& value) {
+        Remove(value);
+        PushBack(value);
+    }
+
+    T& Front() {
+        if (IsEmpty()) {
+            throw std::out_of_range("List is empty");
+        }
+        return Owner(sentinel.next);
+    }
+
+    T& Back() {
+        if (IsEmpty()) {
+            throw std::out_of_range("List is empty");
+        }
+        return Owner(sentinel.prev);
+    }
+
+    void Clear() {
+        while (!IsEmpty()) {
+            Unlink(sentinel.next);
+        }
+    }
+
+    bool IsEmpty() const { return listSize == 0; }
+
+    int Size() const { return listSize; }
+
+    IntrusiveListIterator<T, Tag> Iterator() { return IntrusiveListIterator<T, Tag>(sentinel.next, &sentinel); }
+};
+
+#endif // INTRUSIVELIST_HPP
@@ -0,0 +1,29 @@
+#ifndef INTRUSIVELISTITERATOR_HPP
+#define INTRUSIVELISTITERATOR_HPP
+
+#include <stdexcept>
+
+#include "IntrusiveHook.hpp"
+
+template <typename T, typename Tag = void>
+class IntrusiveListIterator {
+private:
+    IntrusiveHook<Tag>* current;
+    const IntrusiveHook<Tag>* end;
+
+public:
+    IntrusiveListIterator(IntrusiveHook<Tag>* startHook, const IntrusiveHook<Tag>* endHook) : current(startHook), end(endHook) {}
+
+    bool HasNext() const { return current != end; }
+
+    T& Next() {
+        if (current == end) {
+            throw std::out_of_range("No more elements");
+        }
+        T& data = *static_cast<T*>(current);
+        current = current->next;
+        return data;
+    }
+};
+
+#endif // INTRUSIVELISTITERATOR_HPP
@@ -1,38 +1,96 @@
 #ifndef LINKEDLIST_HPP
 #define LINKEDLIST_HPP
 
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "Node.hpp"
 #include "ListIterator.hpp"
+#include "ListAlgorithms.hpp"
+#include "NodePool.hpp"
 
 template <typename T>
 class LinkedList {
 private:
     Node<T>* head;
+    Node<T>* tail; // kept so appends and splices do not walk the list
     int listSize;
+    std::shared_ptr<NodePool<Node<T>>> pool; // nodes are recycled through the pool instead of new/delete
+
+    // Detach all of other's elements as a chain of nodes owned by this list's pool. Nodes are relinked as-is when
+    // both lists share a pool; otherwise each value is moved into a node from this pool. other is left empty.
+    Node<T>* TakeNodes(LinkedList& other, Node<T>*& last) {
+        Node<T>* first = nullptr;
+        last = nullptr;
+        if (other.pool == pool) {
+            first = other.head;
+            last = other.tail;
+            other.head = other.tail = nullptr;
+            other.listSize = 0;
+            return first;
+        }
+        for (Node<T>* temp = other.head; temp; temp = temp->next) {
+            Node<T>* newNode = pool->Allocate(std::move(temp->data));
+            if (last) {
+                last->next = newNode;
+            }
+            else {
+                first = newNode;
+            }
+            last = newNode;
+        }
+        other.Clear();
+        return first;
+    }
 
 public:
-    LinkedList() : head(nullptr), listSize(0) {}
+    LinkedList() : head(nullptr), tail(nullptr), listSize(0), pool(std::make_shared<NodePool<Node<T>>>()) {}
 
-    void Add(T& value) {
-        Node<T>* newNode = new Node<T>(value);
+    // Share a node pool with other lists of the same element type.
+    explicit LinkedList(std::shared_ptr<NodePool<Node<T>>> pool) : head(nullptr), tail(nullptr), listSize(0), pool(pool) {}
+
+    LinkedList(const LinkedList&) = delete;
+    LinkedList& operator=(const LinkedList&) = delete;
+
+    ~LinkedList() { Clear(); }
+
+    void Add(const T& value) { Emplace(value); }
+
+    void Add(T&& value) { Emplace(std::move(value)); }
+
+    // Construct a new last element in place from T's constructor arguments.
+    template <typename... Args>
+    T& Emplace(Args&&... args) {
+        Node<T>* newNode = pool->Allocate(std::forward<Args>(args)...);
         if (!head) {
-            head = newNode;
+            head = tail = newNode;
         }
         else {
-            Node<T>* temp = head;
-            while (temp->next) {
-                temp = temp->next;
-            }
-            temp->next = newNode;
+            tail->next = newNode;
+            tail = newNode;
         }
         listSize++;
+        return newNode->data;
     }
 
-    void Insert(T& value, int index) {
+    void Insert(const T& value, int index) { EmplaceAt(index, value); }
+
+    void Insert(T&& value, int index) { EmplaceAt(index, std::move(value)); }
+
+    // Construct a new element in place so that it ends up at the given index.
+    template <typename... Args>
+    T& EmplaceAt(int index, Args&&... args) {
         if (index < 0 || index > listSize) {
             throw std::out_of_range("Index out of range");
         }
-        Node<T>* newNode = new Node<T>(value);
+        if (index == listSize) {
+            return Emplace(std::forward<Args>(args)...);
+        }
+        Node<T>* newNode = pool->Allocate(std::forward<Args>(args)...);
         if (index == 0) {
             newNode->next = head;
             head = newNode;
@@ -46,6 +104,7 @@ public:
             temp->next = newNode;
         }
         listSize++;
+        return newNode->data;
     }
 
     T& Get(int index) {
@@ -59,7 +118,7 @@ public:
         return temp->data;
     }
 
-    int IndexOf(T& value) {
+    int IndexOf(const T& value) {
         Node<T>* temp = head;
         int index = 0;
         while (temp) {
@@ -72,7 +131,8 @@ public:
         return -1;
     }
 
-    T& Remove(int index) {
+    // Moves the removed value out to the caller; the node's storage goes straight back to the pool.
+    T Remove(int index) {
         if (index < 0 || index >= listSize) {
             throw std::out_of_range("Index out of range");
         }
@@ -87,15 +147,113 @@ public:
                 temp = temp->next;
             }
             prev->next = temp->next;
+            if (temp == tail) {
+                tail = prev;
+            }
+        }
+        if (!head) {
+            tail = nullptr;
         }
         listSize--;
-        T& data = temp->data;
-        delete temp;
+        T data = std::move(temp->data);
+        pool->Release(temp);
         return data;
     }
 
+    // Remove every element. When no other list shares the pool, whole slabs are freed at once
+    // instead of recycling nodes one by one.
+    void Clear() {
+        if (pool.use_count() == 1) {
+            if (!std::is_trivially_destructible<T>::value) {
+                for (Node<T>* temp = head; temp; temp = temp->next) {
+                    temp->~Node<T>();
+                }
+            }
+            pool->Reset();
+        }
+        else {
+            while (head) {
+                Node<T>* next = head->next;
+                pool->Release(head);
+                head = next;
+            }
+        }
+        head = tail = nullptr;
+        listSize = 0;
+    }
+
+    // Copy the elements into a contiguous vector.
+    std::vector<T> ToVector() const { return FlattenNodes(head, listSize); }
+
+    // Copy every element satisfying pred, in order, evaluating pred over up to `threads` segments concurrently.
+    template <typename Predicate>
+    std::vector<T> FindAll(Predicate pred, int threads = 1) const { return FindAllNodes(head, listSize, pred, threads); }
+
+    // Stable merge sort that relinks nodes; no element is copied or moved.
+    template <typename Compare = std::less<T>>
+    void Sort(Compare less = Compare()) {
+        head = MergeSortNodes(head, listSize, less);
+        for (tail = head; tail && tail->next; tail = tail->next) {}
+    }
+
+    // Move all of other's elements into this list so they start at index. O(1) plus the walk to index when
+    // both lists share a node pool; appending (index == Size()) links after the tail without walking.
+    void Splice(int index, LinkedList& other) {
+        if (index < 0 || index > listSize) {
+            throw std::out_of_range("Index out of range");
+        }
+        if (&other == this || other.listSize == 0) {
+            return;
+        }
+        int count = other.listSize;
+        Node<T>* last;
+        Node<T>* first = TakeNodes(other, last);
+        if (index == 0) {
+            last->next = head;
+            head = first;
+        }
+        else if (index == listSize) {
+            last->next = nullptr;
+            tail->next = first;
+        }
+        else {
+            Node<T>* temp = head;
+            for (int i = 1; i < index; i++) {
+                temp = temp->next;
+            }
+            last->next = temp->next;
+            temp->next = first;
+        }
+        if (!last->next) {
+            tail = last;
+        }
+        listSize += count;
+    }
+
+    // Append all of other's elements.
+    void Splice(LinkedList& other) { Splice(listSize, other); }
+
+    // Merge the sorted list other into this sorted list by relinking nodes; other is left empty.
+    template <typename Compare = std::less<T>>
+    void Merge(LinkedList& other, Compare less = Compare()) {
+        if (&other == this || other.listSize == 0) {
+            return;
+        }
+        int count = other.listSize;
+        Node<T>* last;
+        Node<T>* first = TakeNodes(other, last);
+        head = MergeNodes(head, first, less);
+        if (!tail || !less(last->data, tail->data)) {
+            tail = last; // ties keep this list's elements first, so other's last element ends the merged list
+        }
+        listSize += count;
+    }
+
     int Size() const { return listSize; }
 
+    // Node pool backing this list, for sharing and allocation instrumentation.
+    std::shared_ptr<NodePool<Node<T>>> Pool() const { return pool; }
+
     typename ListIterator<T>::Iterator Iterator() { return typename ListIterator<T>::Iterator(head); } //
 };
 
@@ -0,0 +1,131 @@
+#ifndef LISTALGORITHMS_HPP
+#define LISTALGORITHMS_HPP
+
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Node-level algorithms shared by LinkedList and DoublyLinkedList.
+// They work on chains linked through `next` and ignore `prev`; the doubly linked list repairs its back links afterwards.
+
+// Cut a chain after its first count nodes and return the remainder (nullptr if the chain is not longer than count).
+template <typename NodeType>
+NodeType* SplitAfter(NodeType* head, int count) {
+    for (int i = 1; head && i < count; i++) {
+        head = head->next;
+    }
+    if (!head) {
+        return nullptr;
+    }
+    NodeType* rest = head->next;
+    head->next = nullptr;
+    return rest;
+}
+
+// Merge two sorted chains by relinking their nodes. Stable: on ties nodes from first come before nodes from second.
+template <typename NodeType, typename Compare>
+NodeType* MergeNodes(NodeType* first, NodeType* second, Compare less) {
+    NodeType* merged = nullptr;
+    NodeType** link = &merged;
+    while (first && second) {
+        if (less(second->data, first->data)) {
+            *link = second;
+            second = second->next;
+        }
+        else {
+            *link = first;
+            first = first->next;
+        }
+        link = &(*link)->next;
+    }
+    *link = first ? first : second;
+    return merged;
+}
+
+// Stable bottom-up merge sort of a chain of the given length, in place on the nodes with O(1) extra memory.
+// Values are never copied or moved; only next pointers change. Returns the new head.
+template <typename NodeType, typename Compare>
+NodeType* MergeSortNodes(NodeType* head, int length, Compare less) {
+    for (int width = 1; width < length; width *= 2) {
+        NodeType* remaining = head;
+        NodeType** link = &head; // where the next merged run is attached
+        while (remaining) {
+            NodeType* left = remaining;
+            NodeType* right = SplitAfter(left, width);
+            remaining = SplitAfter(right, width);
+            *link = MergeNodes(left, right, less);
+            while (*link) {
+                link = &(*link)->next;
+            }
+        }
+    }
+    return head;
+}
+
+// Copy the values of a chain into a contiguous vector, which is what vectorised numeric code wants to scan.
+template <typename NodeType>
+auto FlattenNodes(NodeType* head, int length) -> std::vector<decltype(head->data)> {
+    std::vector<decltype(head->data)> values;
+    values.reserve(length);
+    for (; head; head = head->next) {
+        values.push_back(head->data);
+    }
+    return values;
+}
+
+// Copy every value that satisfies pred, in list order.
+// With threads > 1 the chain is cut into that many contiguous segments and pred runs on each segment concurrently,
+// which pays off when pred is expensive relative to following a pointer. pred must be safe to call concurrently.
+template <typename NodeType, typename Predicate>
+auto FindAllNodes(NodeType* head, int length, Predicate pred, int threads) -> std::vector<decltype(head->data)> {
+    typedef decltype(head->data) T;
+    if (threads > length) {
+        threads = length;
+    }
+    if (threads <= 1) {
+        std::vector<T> matches;
+        for (; head; head = head->next) {
+            if (pred(head->data)) {
+                matches.push_back(head->data);
+            }
+        }
+        return matches;
+    }
+
+    // One pass to find where each segment starts.
+    std::vector<NodeType*> starts(threads);
+    std::vector<int> lengths(threads);
+    NodeType* current = head;
+    for (int s = 0; s < threads; s++) {
+        lengths[s] = length / threads + (s < length % threads ? 1 : 0);
+        starts[s] = current;
+        for (int i = 0; i < lengths[s]; i++) {
+            current = current->next;
+        }
+    }
+
+    std::vector<std::vector<T>> segmentMatches(threads);
+    std::vector<std::thread> workers;
+    for (int s = 0; s < threads; s++) {
+        workers.emplace_back([&, s]() {
+            NodeType* node = starts[s];
+            for (int i = 0; i < lengths[s]; i++, node = node->next) {
+                if (pred(node->data)) {
+                    segmentMatches[s].push_back(node->data);
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<T> matches;
+    for (std::vector<T>& segment : segmentMatches) {
+        matches.insert(matches.end(), std::make_move_iterator(segment.begin()), std::make_move_iterator(segment.end()));
+    }
+    return matches;
+}
+
+#endif // LISTALGORITHMS_HPP
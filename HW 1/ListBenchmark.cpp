@@ -0,0 +1,136 @@
+// Benchmark of copy vs move vs emplace insertion and move-out removal for LinkedList and DoublyLinkedList.
+// Payloads are heap-backed std::strings and Bonds from the HW2 product model. Global operator new is
+// instrumented so each case also reports heap allocations per element; node slabs are reserved up front
+// so only payload copies show up in that count. Bond's constructor assigns from by-value string parameters,
+// so Bond emplacement still pays for those string copies inside the constructor itself.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "LinkedList.hpp"
+#include "DoublyLinkedList.hpp"
+#include "products.hpp"
+
+static long allocationCount = 0;
+
+void* operator new(std::size_t size)
+{
+    allocationCount++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Time one case and print ns and heap allocations per element.
+template <typename F>
+void Measure(const std::string& name, int count, F body)
+{
+    long allocationsBefore = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    std::cout << "  " << name << ": " << ns / count << " ns/element, "
+              << double(allocationCount - allocationsBefore) / count << " allocations/element" << std::endl;
+}
+
+template <typename List>
+void BenchmarkStrings(const std::string& listName, int count)
+{
+    std::cout << listName << "<std::string>" << std::endl;
+    const std::string text(64, 'x'); // longer than the small-string buffer, so every copy allocates
+
+    std::vector<std::string> source(count, text);
+    List copied;
+    copied.Pool()->Reserve(count);
+    Measure("Add(const T&)", count, [&]() {
+        for (int i = 0; i < count; i++) {
+            copied.Add(source[i]);
+        }
+    });
+
+    List moved;
+    moved.Pool()->Reserve(count);
+    Measure("Add(T&&)", count, [&]() {
+        for (int i = 0; i < count; i++) {
+            moved.Add(std::move(source[i]));
+        }
+    });
+
+    List emplaced;
+    emplaced.Pool()->Reserve(count);
+    Measure("Emplace(args...)", count, [&]() {
+        for (int i = 0; i < count; i++) {
+            emplaced.Emplace(64, 'x');
+        }
+    });
+
+    std::vector<std::string> sink;
+    sink.reserve(count);
+    Measure("Remove(0) moved out", count, [&]() {
+        for (int i = 0; i < count; i++) {
+            sink.push_back(moved.Remove(0));
+        }
+    });
+}
+
+template <typename List>
+void BenchmarkBonds(const std::string& listName, int count)
+{
+    std::cout << listName << "<Bond>" << std::endl;
+    date maturityDate(2025, Nov, 16);
+    const string cusip = "912828M56-REOPENING-2025"; // long id so the Bond's strings live on the heap
+    const string ticker = "T";
+
+    std::vector<Bond> source(count, Bond(cusip, CUSIP, ticker, 2.25, maturityDate));
+    List copied;
+    copied.Pool()->Reserve(count);
+    Measure("Add(const T&)", count, [&]() {
+        for (int i = 0; i < count; i++) {
+            copied.Add(source[i]);
+        }
+    });
+
+    List moved;
+    moved.Pool()->Reserve(count);
+    Measure("Add(T&&)", count, [&]() {
+        for (int i = 0; i < count; i++) {
+            moved.Add(std::move(source[i]));
+        }
+    });
+
+    List emplaced;
+    emplaced.Pool()->Reserve(count);
+    Measure("Emplace(args...)", count, [&]() {
+        for (int i = 0; i < count; i++) {
+            emplaced.Emplace(cusip, CUSIP, ticker, 2.25f, maturityDate);
+        }
+    });
+
+    std::vector<Bond> sink;
+    sink.reserve(count);
+    Measure("Remove(0) moved out", count, [&]() {
+        for (int i = 0; i < count; i++) {
+            sink.push_back(moved.Remove(0));
+        }
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    BenchmarkStrings<LinkedList<std::string>>("LinkedList", count);
+    BenchmarkStrings<DoublyLinkedList<std::string>>("DoublyLinkedList", count);
+    BenchmarkBonds<LinkedList<Bond>>("LinkedList", count);
+    BenchmarkBonds<DoublyLinkedList<Bond>>("DoublyLinkedList", count);
+    return 0;
+}
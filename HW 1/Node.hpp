@@ -1,13 +1,17 @@
 #ifndef NODE_HPP
 #define NODE_HPP
 
+#include <utility>
+
 template <typename T>
 class Node {
 public:
     T data;
     Node<T>* next;
 
-    Node(T data) : data(data), next(nullptr) {}
+    // Construct the value in place from whatever arguments T accepts (a T to copy or move, or ctor args).
+    template <typename... Args>
+    explicit Node(Args&&... args) : data(std::forward<Args>(args)...), next(nullptr) {}
 };
 
 #endif // NODE_HPP
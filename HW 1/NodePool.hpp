@@ -0,0 +1,116 @@
+#ifndef NODEPOOL_HPP
+#define NODEPOOL_HPP
+
+#include <new>
+#include <utility>
+#include <vector>
+
+// Slab allocator for list nodes.
+// Nodes are carved out of fixed-size slabs and released nodes go on a free list that is used before any new slab
+// is requested, so a list under steady add/remove churn stops calling malloc once it has reached its peak size.
+// A pool may be shared by several lists of the same element type (see LinkedList/DoublyLinkedList constructors).
+template <typename NodeType>
+class NodePool {
+private:
+    union Slot {
+        Slot* nextFree;
+        alignas(NodeType) unsigned char storage[sizeof(NodeType)];
+    };
+
+    std::vector<Slot*> slabs;
+    Slot* freeList;
+    int slabSize;
+    int liveNodes;
+
+    // Instrumentation counters.
+    long slabAllocations;
+    long slabReleases;
+    long nodeAllocations;
+    long nodeReleases;
+
+    void AddSlab() {
+        Slot* slab = new Slot[slabSize];
+        slabs.push_back(slab);
+        for (int i = slabSize - 1; i >= 0; i--) {
+            slab[i].nextFree = freeList;
+            freeList = &slab[i];
+        }
+        slabAllocations++;
+    }
+
+public:
+    explicit NodePool(int slabSize = 64) : freeList(nullptr), slabSize(slabSize > 0 ? slabSize : 1), liveNodes(0),
+        slabAllocations(0), slabReleases(0), nodeAllocations(0), nodeReleases(0) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // Any nodes still live are not destroyed; their owning lists clear them first.
+    ~NodePool() { Reset(); }
+
+    // Construct a node in a recycled slot, or in a fresh slab if the free list is empty.
+    template <typename... Args>
+    NodeType* Allocate(Args&&... args) {
+        if (!freeList) {
+            AddSlab();
+        }
+        Slot* slot = freeList;
+        freeList = slot->nextFree;
+        NodeType* node;
+        try {
+            node = new (slot->storage) NodeType(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            slot->nextFree = freeList;
+            freeList = slot;
+            throw;
+        }
+        liveNodes++;
+        nodeAllocations++;
+        return node;
+    }
+
+    // Destroy a node and put its slot back on the free list.
+    void Release(NodeType* node) {
+        node->~NodeType();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->nextFree = freeList;
+        freeList = slot;
+        liveNodes--;
+        nodeReleases++;
+    }
+
+    // Make sure at least the given number of nodes can be allocated without another slab.
+    void Reserve(int nodes) {
+        int available = static_cast<int>(slabs.size()) * slabSize - liveNodes;
+        while (available < nodes) {
+            AddSlab();
+            available += slabSize;
+        }
+    }
+
+    // Free every slab at once without visiting individual nodes.
+    // Callers must already have destroyed the values held by any live nodes.
+    void Reset() {
+        for (Slot* slab : slabs) {
+            delete[] slab;
+        }
+        slabReleases += static_cast<long>(slabs.size());
+        slabs.clear();
+        freeList = nullptr;
+        liveNodes = 0;
+    }
+
+    int LiveNodes() const { return liveNodes; }
+    int Capacity() const { return static_cast<int>(slabs.size()) * slabSize; }
+
+    // Number of times the pool went to the heap (one per slab), and how many slabs it has returned.
+    long SlabAllocations() const { return slabAllocations; }
+    long SlabReleases() const { return slabReleases; }
+
+    // Number of nodes handed out and taken back over the lifetime of the pool.
+    long NodeAllocations() const { return nodeAllocations; }
+    long NodeReleases() const { return nodeReleases; }
+};
+
+#endif // NODEPOOL_HPP
@@ -4,6 +4,7 @@
 
 #include "LinkedList.hpp"
 #include "DoublyLinkedList.hpp"
+#include "IntrusiveList.hpp"
 
 // Implementation of Hasher for std::string.
 class StringHasher : public Hasher<std::string>
@@ -86,6 +87,178 @@ void test_Hashtable()
     }
 }
 
+// Tags naming the two lists an Order can belong to at the same time.
+struct LruTag {};
+struct QueueTag {};
+
+// An order that carries its own links, so queueing it never allocates or copies.
+struct Order : public IntrusiveHook<LruTag>, public IntrusiveHook<QueueTag>
+{
+    int id;
+    double price;
+
+    Order(int id, double price) : id(id), price(price) {}
+};
+
+void test_IntrusiveList()
+{
+    Order o1(1, 99.5), o2(2, 100.0), o3(3, 100.25), o4(4, 100.5);
+
+    // Order queue: FIFO of resting orders.
+    IntrusiveList<Order, QueueTag> queue;
+    queue.PushBack(o1);
+    queue.PushBack(o2);
+    queue.PushBack(o3);
+    queue.PushBack(o4);
+
+    // Cancel an order in the middle of the queue by reference in O(1).
+    queue.Remove(o2);
+    std::cout << "Order queue after cancelling order 2: ";
+    auto qiterator = queue.Iterator();
+    while (qiterator.HasNext()) {
+        std::cout << qiterator.Next().id << " ";
+    }
+    std::cout << std::endl;
+
+    // LRU list over the same objects: most recently touched at the front.
+    IntrusiveList<Order, LruTag> lru;
+    lru.PushFront(o1);
+    lru.PushFront(o2);
+    lru.PushFront(o3);
+    lru.MoveToFront(o1); // touch order 1
+    std::cout << "LRU order after touching order 1: ";
+    auto literator = lru.Iterator();
+    while (literator.HasNext()) {
+        std::cout << literator.Next().id << " ";
+    }
+    std::cout << std::endl;
+
+    // Evict the least recently used element.
+    std::cout << "Evicted from LRU: " << lru.PopBack().id << std::endl;
+    std::cout << "LRU size: " << lru.Size() << ", queue size: " << queue.Size() << std::endl;
+
+    // An element cannot be linked twice into the same list.
+    try
+    {
+        queue.PushBack(o1);
+    }
+    catch (const std::logic_error& err)
+    {
+        std::cout << "Order 1 is already queued: " << err.what() << std::endl;
+    }
+}
+
+void test_NodePool()
+{
+    // Two lists sharing one node pool: nodes freed by one are reused by the other.
+    auto pool = std::make_shared<NodePool<DNode<int>>>(32);
+    DoublyLinkedList<int> bids(pool), asks(pool);
+
+    // Warm up to the peak size once.
+    for (int i = 0; i < 100; i++) {
+        bids.Add(i);
+        asks.Add(i);
+    }
+    long slabsAfterWarmup = pool->SlabAllocations();
+
+    // Steady-state churn: every removed node is recycled, so no further slabs are requested.
+    for (int round = 0; round < 10000; round++) {
+        int value = bids.Remove(0);
+        asks.Add(value);
+        value = asks.Remove(0);
+        bids.Add(value);
+    }
+    std::cout << "Slabs allocated during warm-up: " << slabsAfterWarmup << std::endl;
+    std::cout << "Slabs allocated during 20000 add/remove pairs: " << pool->SlabAllocations() - slabsAfterWarmup << std::endl;
+    std::cout << "Nodes handed out: " << pool->NodeAllocations() << ", live: " << pool->LiveNodes() << std::endl;
+
+    // Bulk clear of a list that owns its pool frees whole slabs.
+    LinkedList<int> scratch;
+    for (int i = 0; i < 1000; i++) {
+        scratch.Add(i);
+    }
+    scratch.Clear();
+    std::cout << "Scratch list slabs allocated/released: " << scratch.Pool()->SlabAllocations() << "/"
+              << scratch.Pool()->SlabReleases() << ", size after Clear: " << scratch.Size() << std::endl;
+}
+
+void test_SequentialAccess()
+{
+    // Sequential Get(i) continues from the cached finger, so a full indexed pass is O(n) rather than O(n^2).
+    DoublyLinkedList<int> replay;
+    const int count = 100000;
+    for (int i = 0; i < count; i++) {
+        replay.Add(i);
+    }
+    long long sum = 0;
+    for (int i = 0; i < replay.Size(); i++) {
+        sum += replay.Get(i);
+    }
+    std::cout << "Sum of " << count << " elements by index: " << sum << std::endl;
+
+    // Access near the tail starts from the tail.
+    std::cout << "Element at index " << count - 2 << ": " << replay.Get(count - 2) << std::endl;
+
+    // Removing while stepping forward stays next to the finger.
+    for (int i = 0; i < replay.Size(); i++) {
+        if (replay.Get(i) % 2 == 1) {
+            replay.Remove(i);
+            i--;
+        }
+    }
+    std::cout << "Size after removing odd elements: " << replay.Size() << std::endl;
+}
+
+void test_BulkOperations()
+{
+    // Two desks' execution prices, each sorted end-of-day and then merged without copying into vectors.
+    auto pool = std::make_shared<NodePool<DNode<double>>>();
+    DoublyLinkedList<double> deskA(pool), deskB(pool);
+    double pricesA[] = { 100.5, 99.25, 101.0, 99.75 };
+    double pricesB[] = { 100.0, 98.5, 102.25 };
+    for (double price : pricesA) {
+        deskA.Add(price);
+    }
+    for (double price : pricesB) {
+        deskB.Add(price);
+    }
+    deskA.Sort();
+    deskB.Sort();
+    deskA.Merge(deskB);
+    std::cout << "Merged executions: ";
+    for (double price : deskA.ToVector()) {
+        std::cout << price << " ";
+    }
+    std::cout << "(desk B now has " << deskB.Size() << " elements)" << std::endl;
+
+    // Parallel scan over segments of the list.
+    std::vector<double> above100 = deskA.FindAll([](double price) { return price > 100.0; }, 2);
+    std::cout << "Executions above 100: " << above100.size() << std::endl;
+
+    // Splice a late batch into the middle of a singly linked list.
+    LinkedList<int> ids, late;
+    for (int i = 1; i <= 4; i++) {
+        ids.Add(i * 10);
+    }
+    late.Add(25);
+    late.Add(26);
+    ids.Splice(2, late);
+    std::cout << "Ids after splice: ";
+    for (int id : ids.ToVector()) {
+        std::cout << id << " ";
+    }
+    std::cout << std::endl;
+
+    // Sort descending with a custom comparator.
+    ids.Sort([](int a, int b) { return a > b; });
+    std::cout << "Ids sorted descending: ";
+    auto iterator = ids.Iterator();
+    while (iterator.HasNext()) {
+        std::cout << iterator.Next() << " ";
+    }
+    std::cout << std::endl;
+}
+
 int main()
 {
     //Q1
@@ -189,6 +362,7 @@ int main()
 
     // Finding the index of an element
     std::cout << "Index of " << y << ": " << dlList.IndexOf(y) << std::endl;
+    std::cout << "Last index of " << x << ": " << dlList.LastIndexOf(x) << std::endl;
 
     // Adding another element
     dlList.Add(v);
@@ -205,5 +379,21 @@ int main()
 
     //Q3
     test_Hashtable();
+
+    //Intrusive list
+    std::cout << "Starting Intrusive List Test Cases:" << std::endl;
+    test_IntrusiveList();
+
+    //Node pool
+    std::cout << "Starting Node Pool Test Cases:" << std::endl;
+    test_NodePool();
+
+    //Sequential access
+    std::cout << "Starting Sequential Access Test Cases:" << std::endl;
+    test_SequentialAccess();
+
+    //Bulk operations
+    std::cout << "Starting Bulk Operations Test Cases:" << std::endl;
+    test_BulkOperations();
     return 0;
 }
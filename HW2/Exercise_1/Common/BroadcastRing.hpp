@@ -0,0 +1,199 @@
+// Single-writer, multi-reader broadcast ring (disruptor style) designed to live inside a shared mapped_region.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Platform.hpp"
+
+/**
+ * Every reader sees every item the writer publishes, in order.
+ * Items are stamped with a sequence number; each reader keeps its own cursor, so readers never contend with each
+ * other and the writer never waits for anyone. A reader that falls more than Capacity items behind is overrun: it
+ * detects this from the slot sequence stamps and must resynchronise instead of reading overwritten data.
+ * Readers also register a status slot so the writer (or a monitor) can see how far behind each one is.
+ */
+template <typename T, std::size_t Capacity, std::size_t MaxReaders = 8>
+class BroadcastRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "Items are copied between processes");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Sequences must be lock-free to be shared across processes");
+
+public:
+    // Status published by each registered reader.
+    struct ReaderStatus
+    {
+        alignas(CacheLineSize) std::atomic<std::uint32_t> active{0};
+        char name[28] = {};
+        std::atomic<std::uint64_t> cursor{0};   // Next sequence the reader will consume.
+        std::atomic<std::uint64_t> overruns{0}; // Number of times the reader was lapped by the writer.
+        std::atomic<std::uint64_t> lost{0};     // Items skipped when resynchronising after an overrun.
+    };
+
+    BroadcastRing() {}
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    // Writer: publish one item.
+    void Publish(const T& item)
+    {
+        PublishBatch(&item, 1);
+    }
+
+    // Writer: publish several items, then advance the shared cursor once. Never blocks.
+    void PublishBatch(const T* items, std::size_t count)
+    {
+        std::uint64_t sequence = cursor.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < count; i++, sequence++)
+        {
+            Slot& slot = slots[sequence & (Capacity - 1)];
+            // Mark the slot as being rewritten before touching the payload, so a lapped reader notices.
+            slot.sequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(&slot.item, &items[i], sizeof(T));
+            slot.sequence.store(sequence + 1, std::memory_order_release);
+        }
+        cursor.store(sequence, std::memory_order_release);
+    }
+
+    // Number of items published so far; the next item will carry this sequence.
+    std::uint64_t Cursor() const { return cursor.load(std::memory_order_acquire); }
+
+    static constexpr std::size_t GetCapacity() { return Capacity; }
+    static constexpr std::size_t GetMaxReaders() { return MaxReaders; }
+
+    const ReaderStatus& GetReaderStatus(std::size_t index) const { return readers[index]; }
+
+private:
+    template <typename, std::size_t, std::size_t> friend class BroadcastReader;
+
+    struct Slot
+    {
+        alignas(CacheLineSize) std::atomic<std::uint64_t> sequence{0}; // sequence + 1 of the item held, 0 while being written.
+        T item;
+    };
+
+    alignas(CacheLineSize) std::atomic<std::uint64_t> cursor{0}; // Written only by the writer.
+    ReaderStatus readers[MaxReaders];
+    Slot slots[Capacity];
+};
+
+/**
+ * Process-local handle through which one reader consumes a BroadcastRing.
+ * Poll copies items into the caller's buffer; if the writer has lapped the reader, Poll stops, Overrun() becomes
+ * true, and the reader decides whether to Resync() to the live end of the ring.
+ */
+template <typename T, std::size_t Capacity, std::size_t MaxReaders = 8>
+class BroadcastReader
+{
+public:
+    typedef BroadcastRing<T, Capacity, MaxReaders> Ring;
+
+    // Register under the given name and start at the writer's current position.
+    // Throws std::runtime_error if all reader status slots are taken.
+    BroadcastReader(Ring& ring, const char* name) : ring(ring), status(nullptr), cursor(ring.Cursor()), overrun(false)
+    {
+        for (std::size_t i = 0; i < MaxReaders && !status; i++)
+        {
+            std::uint32_t expected = 0;
+            if (ring.readers[i].active.compare_exchange_strong(expected, 1, std::memory_order_acq_rel))
+            {
+                status = &ring.readers[i];
+            }
+        }
+        if (!status)
+        {
+            throw std::runtime_error("No free reader slot in the broadcast ring");
+        }
+        std::strncpy(status->name, name, sizeof(status->name) - 1);
+        status->cursor.store(cursor, std::memory_order_release);
+    }
+
+    ~BroadcastReader()
+    {
+        status->active.store(0, std::memory_order_release);
+    }
+
+    BroadcastReader(const BroadcastReader&) = delete;
+    BroadcastReader& operator=(const BroadcastReader&) = delete;
+
+    // Copy up to maxCount new items into items and return how many were copied. Returns 0 when caught up or overrun.
+    std::size_t Poll(T* items, std::size_t maxCount)
+    {
+        if (overrun)
+        {
+            return 0;
+        }
+        const std::uint64_t published = ring.cursor.load(std::memory_order_acquire);
+        if (published - cursor > Capacity)
+        {
+            MarkOverrun();
+            return 0;
+        }
+        std::size_t count = 0;
+        while (count < maxCount && cursor < published)
+        {
+            const typename Ring::Slot& slot = ring.slots[cursor & (Capacity - 1)];
+            const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before != cursor + 1)
+            {
+                MarkOverrun();
+                break;
+            }
+            std::memcpy(&items[count], &slot.item, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before)
+            {
+                MarkOverrun(); // The writer started rewriting the slot while we copied it.
+                break;
+            }
+            cursor++;
+            count++;
+        }
+        if (count > 0)
+        {
+            status->cursor.store(cursor, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // True after the writer has lapped this reader; cleared by Resync.
+    bool Overrun() const { return overrun; }
+
+    // Skip to the writer's current position. Returns the number of items that were lost.
+    std::uint64_t Resync()
+    {
+        const std::uint64_t published = ring.cursor.load(std::memory_order_acquire);
+        const std::uint64_t skipped = published - cursor;
+        cursor = published;
+        overrun = false;
+        status->lost.fetch_add(skipped, std::memory_order_relaxed);
+        status->cursor.store(cursor, std::memory_order_release);
+        return skipped;
+    }
+
+    // Next sequence this reader will consume.
+    std::uint64_t Cursor() const { return cursor; }
+
+    // Items published but not yet consumed by this reader.
+    std::uint64_t Lag() const { return ring.Cursor() - cursor; }
+
+private:
+    void MarkOverrun()
+    {
+        overrun = true;
+        status->overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Ring& ring;
+    typename Ring::ReaderStatus* status;
+    std::uint64_t cursor;
+    bool overrun;
+};
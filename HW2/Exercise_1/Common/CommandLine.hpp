@@ -0,0 +1,45 @@
+// Minimal "--name value" command line parsing for the Writer and Reader programs.
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Return the value following the given option, or the default if the option is absent.
+inline long long GetOption(int argc, char* argv[], const char* name, long long defaultValue)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], name) == 0)
+        {
+            return std::atoll(argv[i + 1]);
+        }
+    }
+    return defaultValue;
+}
+
+inline std::string GetOption(int argc, char* argv[], const char* name, const std::string& defaultValue)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], name) == 0)
+        {
+            return argv[i + 1];
+        }
+    }
+    return defaultValue;
+}
+
+// True if the given flag appears anywhere on the command line.
+inline bool HasFlag(int argc, char* argv[], const char* name)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
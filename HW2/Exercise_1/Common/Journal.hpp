@@ -0,0 +1,259 @@
+// Append-only journal of published updates, written through memory-mapped files so that a session can be replayed.
+
+#pragma once
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "Messages.hpp"
+#include "Platform.hpp"
+
+// First cache line of every segment file.
+struct JournalHeader
+{
+    static constexpr std::uint64_t Magic = 0x31304C4E524A5850ull; // "PXJRNL01"
+    static constexpr std::uint32_t Version = 1;
+
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t recordSize;      // sizeof(PriceUpdate) when the journal was written.
+    std::uint64_t capacity;        // Records the segment can hold.
+    std::uint64_t segmentIndex;    // Position of the segment in the journal, from 0.
+    std::atomic<std::uint64_t> count; // Committed records; everything after is garbage from a crash.
+    std::atomic<std::uint32_t> sealed; // Set once the writer has moved on to the next segment or closed the journal.
+};
+
+static_assert(sizeof(JournalHeader) <= CacheLineSize, "The journal header must fit in one cache line");
+
+// Records start one cache line into each segment.
+constexpr std::size_t JournalRecordOffset = CacheLineSize;
+
+// Name of a segment file: the journal path followed by a six-digit segment index.
+inline std::string JournalSegmentPath(const std::string& path, std::uint64_t index)
+{
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), ".%06llu", static_cast<unsigned long long>(index));
+    return path + suffix;
+}
+
+/**
+ * Writes PriceUpdates into a chain of fixed-size memory-mapped segment files.
+ * Claim hands out space inside the mapping so the caller builds records in place (no copy into a write buffer), and
+ * Commit publishes them by bumping the segment header's count. Committed data is handed to the kernel with an
+ * asynchronous msync every flushEvery records, so the hot path never waits for the disk; a full segment is sealed,
+ * flushed synchronously and replaced by the next one.
+ */
+class JournalWriter
+{
+public:
+    JournalWriter(const std::string& path, std::uint64_t recordsPerSegment = 1 << 20, std::uint64_t flushEvery = 65536)
+        : path(path), recordsPerSegment(recordsPerSegment), flushEvery(flushEvery), segmentIndex(0), header(nullptr),
+          records(nullptr), committed(0), flushed(0), totalRecords(0)
+    {
+        if (recordsPerSegment == 0)
+        {
+            throw std::invalid_argument("A journal segment must hold at least one record");
+        }
+        // Start a fresh journal: segments left by an earlier, longer run would otherwise be replayed after ours.
+        for (std::uint64_t index = 0; std::remove(JournalSegmentPath(path, index).c_str()) == 0; index++)
+        {
+        }
+        OpenSegment();
+    }
+
+    ~JournalWriter()
+    {
+        Seal();
+    }
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    // Space for up to count records, contiguous in the current segment. count is reduced if the segment has less room
+    // left; a full segment is rolled over first, so at least one record is always granted.
+    PriceUpdate* Claim(std::size_t& count)
+    {
+        if (committed == recordsPerSegment)
+        {
+            Seal();
+            segmentIndex++;
+            OpenSegment();
+        }
+        if (count > recordsPerSegment - committed)
+        {
+            count = static_cast<std::size_t>(recordsPerSegment - committed);
+        }
+        return records + committed;
+    }
+
+    // Publish the first count records of the last claim.
+    void Commit(std::size_t count)
+    {
+        committed += count;
+        totalRecords += count;
+        header->count.store(committed, std::memory_order_release);
+        if (committed - flushed >= flushEvery)
+        {
+            Flush(true);
+        }
+    }
+
+    // Hand committed records and the header to the kernel; with async false, wait until they are on disk.
+    void Flush(bool async)
+    {
+        // A length of 0 would make mapped_region::flush write everything from the offset on, so skip empty ranges.
+        if (committed > flushed)
+        {
+            const std::size_t begin = JournalRecordOffset + flushed * sizeof(PriceUpdate);
+            region->flush(begin, (committed - flushed) * sizeof(PriceUpdate), async);
+        }
+        region->flush(0, sizeof(JournalHeader), async);
+        flushed = committed;
+    }
+
+    // Records committed over all segments.
+    std::uint64_t Records() const { return totalRecords; }
+
+    // Segment files written so far.
+    std::uint64_t Segments() const { return segmentIndex + 1; }
+
+private:
+    // Create, size and map the next segment file.
+    void OpenSegment()
+    {
+        const std::string segmentPath = JournalSegmentPath(path, segmentIndex);
+        const std::size_t size = JournalRecordOffset + recordsPerSegment * sizeof(PriceUpdate);
+        {
+            std::filebuf file;
+            if (!file.open(segmentPath.c_str(), std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios_base::binary))
+            {
+                throw std::runtime_error("Cannot create journal segment " + segmentPath);
+            }
+            file.pubseekoff(size - 1, std::ios_base::beg);
+            file.sputc(0);
+        }
+        boost::interprocess::file_mapping mapping(segmentPath.c_str(), boost::interprocess::read_write);
+        region.reset(new boost::interprocess::mapped_region(mapping, boost::interprocess::read_write));
+        region->advise(boost::interprocess::mapped_region::advice_sequential);
+
+        char* base = static_cast<char*>(region->get_address());
+        header = new (base) JournalHeader;
+        header->magic = JournalHeader::Magic;
+        header->version = JournalHeader::Version;
+        header->recordSize = sizeof(PriceUpdate);
+        header->capacity = recordsPerSegment;
+        header->segmentIndex = segmentIndex;
+        header->count.store(0, std::memory_order_relaxed);
+        header->sealed.store(0, std::memory_order_release);
+        records = reinterpret_cast<PriceUpdate*>(base + JournalRecordOffset);
+        committed = 0;
+        flushed = 0;
+    }
+
+    // Mark the current segment complete and wait for it to reach the disk.
+    void Seal()
+    {
+        header->sealed.store(1, std::memory_order_release);
+        Flush(false);
+    }
+
+    std::string path;
+    std::uint64_t recordsPerSegment;
+    std::uint64_t flushEvery;
+    std::uint64_t segmentIndex;
+    std::unique_ptr<boost::interprocess::mapped_region> region;
+    JournalHeader* header;
+    PriceUpdate* records;
+    std::uint64_t committed;    // Records committed to the current segment.
+    std::uint64_t flushed;      // Records of the current segment already handed to msync.
+    std::uint64_t totalRecords;
+};
+
+/**
+ * Reads a journal back segment by segment, in place: Next returns pointers into the mapped files, so replay runs at
+ * memory bandwidth once the pages are cached. Only committed records are returned.
+ * Throws std::runtime_error if the first segment is missing or any segment was written in a different format.
+ */
+class JournalReader
+{
+public:
+    explicit JournalReader(const std::string& path) : path(path), segmentIndex(0), header(nullptr), records(nullptr), position(0)
+    {
+        if (!OpenSegment(0))
+        {
+            throw std::runtime_error("Cannot open journal " + JournalSegmentPath(path, 0));
+        }
+    }
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    // Up to maxCount consecutive committed records, with count set to how many; nullptr at the end of the journal.
+    const PriceUpdate* Next(std::size_t maxCount, std::size_t& count)
+    {
+        while (position == header->count.load(std::memory_order_acquire))
+        {
+            // Move on only from a sealed segment; an unsealed one is the last (the writer stopped or crashed).
+            if (!header->sealed.load(std::memory_order_acquire))
+            {
+                count = 0;
+                return nullptr;
+            }
+            if (!OpenSegment(segmentIndex + 1))
+            {
+                count = 0;
+                return nullptr;
+            }
+        }
+        const std::uint64_t available = header->count.load(std::memory_order_acquire) - position;
+        count = available < maxCount ? static_cast<std::size_t>(available) : maxCount;
+        const PriceUpdate* batch = records + position;
+        position += count;
+        return batch;
+    }
+
+    // Index of the segment being read.
+    std::uint64_t Segment() const { return segmentIndex; }
+
+private:
+    // Map the given segment read-only and validate its header. False if the file does not exist.
+    bool OpenSegment(std::uint64_t index)
+    {
+        const std::string segmentPath = JournalSegmentPath(path, index);
+        if (!std::ifstream(segmentPath.c_str()).good())
+        {
+            return false;
+        }
+        boost::interprocess::file_mapping mapping(segmentPath.c_str(), boost::interprocess::read_only);
+        region.reset(new boost::interprocess::mapped_region(mapping, boost::interprocess::read_only));
+        region->advise(boost::interprocess::mapped_region::advice_sequential);
+
+        const char* base = static_cast<const char*>(region->get_address());
+        header = reinterpret_cast<const JournalHeader*>(base);
+        if (region->get_size() < JournalRecordOffset || header->magic != JournalHeader::Magic || header->version != JournalHeader::Version
+            || header->recordSize != sizeof(PriceUpdate) || header->segmentIndex != index
+            || region->get_size() < JournalRecordOffset + header->capacity * sizeof(PriceUpdate))
+        {
+            throw std::runtime_error("Not a compatible journal segment: " + segmentPath);
+        }
+        records = reinterpret_cast<const PriceUpdate*>(base + JournalRecordOffset);
+        segmentIndex = index;
+        position = 0;
+        return true;
+    }
+
+    std::string path;
+    std::uint64_t segmentIndex;
+    std::unique_ptr<boost::interprocess::mapped_region> region;
+    const JournalHeader* header;
+    const PriceUpdate* records;
+    std::uint64_t position; // Next record of the current segment.
+};
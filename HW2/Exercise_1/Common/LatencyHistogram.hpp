@@ -0,0 +1,162 @@
+// HDR-style latency histogram used to report per-message latency.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * Log-linear histogram of nanosecond values.
+ * Each power of two is split into 32 linear sub-buckets, giving about 3% relative precision over the whole 64-bit
+ * range with a fixed 1920-entry table, so Record is a few instructions and never allocates.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() : counts(BucketCount, 0), totalCount(0), minValue(std::numeric_limits<std::uint64_t>::max()), maxValue(0), sum(0) {}
+
+    void Record(std::uint64_t valueNs)
+    {
+        counts[BucketIndex(valueNs)]++;
+        totalCount++;
+        sum += static_cast<double>(valueNs);
+        if (valueNs < minValue)
+        {
+            minValue = valueNs;
+        }
+        if (valueNs > maxValue)
+        {
+            maxValue = valueNs;
+        }
+    }
+
+    // Add another histogram's samples to this one.
+    void Merge(const LatencyHistogram& other)
+    {
+        for (int i = 0; i < BucketCount; i++)
+        {
+            counts[i] += other.counts[i];
+        }
+        totalCount += other.totalCount;
+        sum += other.sum;
+        if (other.minValue < minValue)
+        {
+            minValue = other.minValue;
+        }
+        if (other.maxValue > maxValue)
+        {
+            maxValue = other.maxValue;
+        }
+    }
+
+    std::uint64_t Count() const { return totalCount; }
+    std::uint64_t Min() const { return totalCount ? minValue : 0; }
+    std::uint64_t Max() const { return maxValue; }
+    double Mean() const { return totalCount ? sum / static_cast<double>(totalCount) : 0.0; }
+
+    // Smallest recorded bucket value that at least the given percentage of samples do not exceed.
+    std::uint64_t Percentile(double percent) const
+    {
+        if (totalCount == 0)
+        {
+            return 0;
+        }
+        std::uint64_t rank = static_cast<std::uint64_t>(percent / 100.0 * static_cast<double>(totalCount) + 0.5);
+        if (rank < 1)
+        {
+            rank = 1;
+        }
+        std::uint64_t seen = 0;
+        for (int i = 0; i < BucketCount; i++)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                std::uint64_t upper = BucketUpperBound(i);
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    // One-line summary: count, min, p50, p90, p99, p99.9, max and mean in nanoseconds.
+    void Print(std::ostream& out, const std::string& label) const
+    {
+        out << label << ": count=" << Count() << " min=" << Min() << " p50=" << Percentile(50) << " p90=" << Percentile(90)
+            << " p99=" << Percentile(99) << " p99.9=" << Percentile(99.9) << " max=" << Max() << " mean=" << Mean() << " (ns)" << std::endl;
+    }
+
+    // Full percentile distribution in the HdrHistogram text layout: each halving of the remaining tail is split into
+    // ticksPerHalf rows, so the p99.9+ tail gets as much detail as the body. Ends with the maximum (100%).
+    void PrintDistribution(std::ostream& out, const std::string& label, int ticksPerHalf = 5) const
+    {
+        out << label << std::endl;
+        out << std::setw(12) << "Value(ns)" << std::setw(15) << "Percentile" << std::setw(12) << "TotalCount" << std::setw(18)
+            << "1/(1-Percentile)" << std::endl;
+        for (int half = 0; totalCount > 0; half++)
+        {
+            const double tailStart = 100.0 * (1.0 - std::ldexp(1.0, -half));
+            if (1.0 / std::ldexp(1.0, -half) > static_cast<double>(totalCount))
+            {
+                break; // Finer percentiles would all be the maximum.
+            }
+            for (int tick = 0; tick < ticksPerHalf; tick++)
+            {
+                PrintDistributionRow(out, tailStart + tick * 100.0 * std::ldexp(1.0, -half - 1) / ticksPerHalf);
+            }
+        }
+        PrintDistributionRow(out, 100.0);
+        out << "#[Mean = " << Mean() << ", Max = " << Max() << ", Total count = " << Count() << "]" << std::endl;
+    }
+
+private:
+    void PrintDistributionRow(std::ostream& out, double percent) const
+    {
+        const double fraction = percent / 100.0;
+        out << std::setw(12) << Percentile(percent) << std::setw(15) << std::fixed << std::setprecision(6) << fraction
+            << std::setw(12) << static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(totalCount)));
+        if (fraction < 1.0)
+        {
+            out << std::setw(18) << std::setprecision(2) << 1.0 / (1.0 - fraction);
+        }
+        out << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+
+    static constexpr int SubBucketBits = 5;
+    static constexpr int SubBucketCount = 1 << SubBucketBits;
+    static constexpr int BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+    // Values below 32 get their own bucket; above that, the top 5 bits below the leading one select the sub-bucket.
+    static int BucketIndex(std::uint64_t value)
+    {
+        if (value < static_cast<std::uint64_t>(SubBucketCount))
+        {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SubBucketBits;
+        return (shift + 1) * SubBucketCount + static_cast<int>((value >> shift) & (SubBucketCount - 1));
+    }
+
+    static std::uint64_t BucketUpperBound(int index)
+    {
+        if (index < 2 * SubBucketCount)
+        {
+            return static_cast<std::uint64_t>(index);
+        }
+        int shift = index / SubBucketCount - 1;
+        std::uint64_t lower = static_cast<std::uint64_t>(index % SubBucketCount + SubBucketCount) << shift;
+        return lower + ((1ull << shift) - 1);
+    }
+
+    std::vector<std::uint64_t> counts;
+    std::uint64_t totalCount;
+    std::uint64_t minValue;
+    std::uint64_t maxValue;
+    double sum;
+};
@@ -0,0 +1,40 @@
+// Layout of the variable-size message path: message bodies live in a shared slab allocator and only handles are queued.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Messages.hpp"
+#include "Platform.hpp"
+#include "SharedSlabAllocator.hpp"
+#include "SpscRingBuffer.hpp"
+#include "WaitStrategy.hpp"
+
+// Name of the shared memory object holding the arena.
+const char* const MessageArenaName = "MyMessageArena";
+
+// 16 MB of message space.
+typedef SharedSlabAllocator<16 << 20> MessageAllocator;
+
+// Largest payload a single message can carry: the header and payload share one block of at most MaxAllocation bytes.
+const std::size_t MaxMessagePayload = MessageAllocator::MaxAllocation - sizeof(VariableMessageHeader);
+
+// What travels through the ring: where the message is, not the message itself.
+struct MessageRef
+{
+    MessageAllocator::Handle handle;
+    std::uint32_t length; // Total bytes in use, header included.
+};
+
+typedef SpscRingBuffer<MessageRef, 4096> MessageRing;
+
+// Everything placed in the mapped region, constructed by the Writer with placement new.
+struct MessageArena
+{
+    alignas(CacheLineSize) std::atomic<std::uint32_t> writerReady{0}; // Set by the Writer once the layout is constructed.
+    std::atomic<std::uint32_t> readerAttached{0}; // Set by the Reader once it has mapped the region.
+    Doorbell doorbell; // Rung by the Writer after every message.
+    MessageRing ring;
+    MessageAllocator allocator;
+};
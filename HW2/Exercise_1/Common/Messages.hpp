@@ -0,0 +1,51 @@
+// Fixed-size messages exchanged through shared memory. They must stay trivially copyable.
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+// Flags carried by a PriceUpdate.
+enum PriceUpdateFlags : std::uint32_t
+{
+    LAST_UPDATE = 1 // The Writer has nothing more to publish.
+};
+
+// Price update streamed from the feed process (Writer) to the pricer (Reader).
+struct PriceUpdate
+{
+    std::uint64_t sequence;      // Publish order, starting at 0.
+    std::uint64_t publishTimeNs; // NowNs() when the Writer published the update.
+    std::uint32_t productIndex;  // Index of the product in the Writer's universe.
+    std::uint32_t flags;         // PriceUpdateFlags.
+    double bid;
+    double ask;
+};
+
+static_assert(std::is_trivially_copyable<PriceUpdate>::value, "PriceUpdate is copied between processes");
+
+// Latest top-of-book quote for one product, published as a snapshot rather than a stream.
+struct Quote
+{
+    std::uint64_t updateNumber;  // Incremented by the Writer on every change.
+    std::uint64_t publishTimeNs; // NowNs() when the Writer published the quote.
+    double bid;
+    double ask;
+    std::uint32_t bidSize;
+    std::uint32_t askSize;
+};
+
+static_assert(std::is_trivially_copyable<Quote>::value, "Quote is copied between processes");
+
+// Header at the start of a variable-size message allocated in shared memory; length payload bytes follow it.
+struct VariableMessageHeader
+{
+    std::uint64_t sequence;      // Publish order, starting at 0.
+    std::uint64_t publishTimeNs; // NowNs() when the Writer published the message.
+    std::uint32_t length;        // Payload bytes following the header.
+    std::uint32_t flags;         // PriceUpdateFlags.
+    std::uint32_t checksum;      // Sum of the payload bytes, so the Reader can verify it read what was written.
+    std::uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<VariableMessageHeader>::value, "VariableMessageHeader is read between processes");
@@ -0,0 +1,44 @@
+// Small platform helpers shared by the Writer and Reader programs.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#include <sys/resource.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Size of a cache line. Indices written by different processes are kept on separate lines to avoid false sharing.
+constexpr std::size_t CacheLineSize = 64;
+
+// Hint to the CPU that we are spinning on a memory location.
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Monotonic clock in nanoseconds. CLOCK_MONOTONIC is system-wide, so timestamps taken in the Writer can be compared
+// with timestamps taken in the Reader.
+inline std::uint64_t NowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+// User plus system CPU time consumed by this process so far, in nanoseconds.
+inline std::uint64_t CpuTimeNs()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (static_cast<std::uint64_t>(usage.ru_utime.tv_sec) + static_cast<std::uint64_t>(usage.ru_stime.tv_sec)) * 1000000000ull
+           + (static_cast<std::uint64_t>(usage.ru_utime.tv_usec) + static_cast<std::uint64_t>(usage.ru_stime.tv_usec)) * 1000ull;
+}
@@ -0,0 +1,27 @@
+// Layout of the price broadcast shared by one Writer and several Readers (risk, pricing, logging, ...).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "BroadcastRing.hpp"
+#include "Messages.hpp"
+#include "Platform.hpp"
+#include "WaitStrategy.hpp"
+
+// Name of the shared memory object holding the broadcast ring.
+const char* const PriceBroadcastName = "MyBroadcastMemory";
+
+// 64K one-cache-line slots: 4 MB, so a reader may fall about 64K updates behind before it is overrun.
+typedef BroadcastRing<PriceUpdate, 65536> PriceBroadcastRing;
+typedef BroadcastReader<PriceUpdate, 65536> PriceBroadcastReader;
+
+// Everything placed in the mapped region, constructed by the Writer with placement new.
+struct PriceBroadcast
+{
+    alignas(CacheLineSize) std::atomic<std::uint32_t> writerReady{0}; // Set by the Writer once the layout is constructed.
+    std::atomic<std::uint32_t> writerDone{0};  // Set by the Writer after its last update, for Readers that resynced past it.
+    Doorbell doorbell; // Rung by the Writer after every batch and once more when done.
+    PriceBroadcastRing ring;
+};
@@ -0,0 +1,26 @@
+// Layout of the price feed shared by the Writer (producer) and Reader (consumer).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Messages.hpp"
+#include "Platform.hpp"
+#include "SpscRingBuffer.hpp"
+#include "WaitStrategy.hpp"
+
+// Name of the shared memory object holding the feed.
+const char* const PriceFeedName = "MySharedMemory";
+
+// 64K updates of 40 bytes: 2.5 MB, enough to absorb scheduling hiccups on either side.
+typedef SpscRingBuffer<PriceUpdate, 65536> PriceRing;
+
+// Everything placed in the mapped region, constructed by the Writer with placement new.
+struct PriceFeed
+{
+    alignas(CacheLineSize) std::atomic<std::uint32_t> writerReady{0};    // Set by the Writer once the layout is constructed.
+    std::atomic<std::uint32_t> readerAttached{0}; // Set by the Reader once it has mapped the region.
+    Doorbell doorbell; // Rung by the Writer after every batch so that a blocked Reader wakes up.
+    PriceRing ring;
+};
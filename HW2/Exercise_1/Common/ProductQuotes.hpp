@@ -0,0 +1,34 @@
+// Layout of the per-product quote table shared by one Writer and any number of read-only Readers.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "Platform.hpp"
+#include "QuoteTable.hpp"
+
+// Name of the shared memory object holding the table.
+const char* const ProductQuotesName = "MyProductQuotes";
+
+// 128K one-cache-line slots: 8 MB, enough for 64K products at a load factor of 1/2.
+typedef QuoteTable<131072> ProductQuoteTable;
+
+// Everything placed in the mapped region, constructed by the Writer with placement new.
+struct ProductQuotes
+{
+    alignas(CacheLineSize) std::atomic<std::uint32_t> writerReady{0}; // Set by the Writer once every product is in the table.
+    std::atomic<std::uint32_t> writerDone{0};   // Set by the Writer after its last update.
+    std::atomic<std::uint32_t> productCount{0}; // Number of products the Writer added.
+    ProductQuoteTable table;
+};
+
+// CUSIP-shaped ID of the index-th product in the benchmark universe, so that both programs generate the same IDs.
+inline std::string MakeProductId(std::uint32_t index)
+{
+    char id[16];
+    std::snprintf(id, sizeof(id), "91%07u", index);
+    return id;
+}
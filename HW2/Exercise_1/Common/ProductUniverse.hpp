@@ -0,0 +1,48 @@
+// Layout of a product universe published by the Writer in flat form and read in place by any number of Readers.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "flatproducts.hpp"
+#include "Platform.hpp"
+
+// Name of the shared memory object holding the universe.
+const char* const ProductUniverseName = "MyProductUniverse";
+
+// Start of the region; the three product arrays follow at the given offsets, each cache-line aligned.
+struct ProductUniverse
+{
+    alignas(CacheLineSize) std::atomic<std::uint32_t> writerReady{0}; // Set by the Writer once every product is in place.
+    std::atomic<std::uint32_t> readersDone{0}; // Incremented by each Reader when it no longer needs the region.
+    std::uint32_t bondCount = 0;
+    std::uint32_t swapCount = 0;
+    std::uint32_t futureCount = 0;
+    std::uint64_t bondsOffset = 0;
+    std::uint64_t swapsOffset = 0;
+    std::uint64_t futuresOffset = 0;
+
+    // Size of a region holding the given numbers of products, with the offsets filled in.
+    std::size_t Layout(std::uint32_t bonds, std::uint32_t swaps, std::uint32_t futures)
+    {
+        bondCount = bonds;
+        swapCount = swaps;
+        futureCount = futures;
+        bondsOffset = AlignUp(sizeof(ProductUniverse));
+        swapsOffset = AlignUp(bondsOffset + bonds * sizeof(FlatBond));
+        futuresOffset = AlignUp(swapsOffset + swaps * sizeof(FlatIRSwap));
+        return futuresOffset + futures * sizeof(FlatFuture);
+    }
+
+    FlatBond* Bonds() { return reinterpret_cast<FlatBond*>(reinterpret_cast<char*>(this) + bondsOffset); }
+    FlatIRSwap* Swaps() { return reinterpret_cast<FlatIRSwap*>(reinterpret_cast<char*>(this) + swapsOffset); }
+    FlatFuture* Futures() { return reinterpret_cast<FlatFuture*>(reinterpret_cast<char*>(this) + futuresOffset); }
+    const FlatBond* Bonds() const { return reinterpret_cast<const FlatBond*>(reinterpret_cast<const char*>(this) + bondsOffset); }
+    const FlatIRSwap* Swaps() const { return reinterpret_cast<const FlatIRSwap*>(reinterpret_cast<const char*>(this) + swapsOffset); }
+    const FlatFuture* Futures() const { return reinterpret_cast<const FlatFuture*>(reinterpret_cast<const char*>(this) + futuresOffset); }
+
+private:
+    static std::uint64_t AlignUp(std::uint64_t offset) { return (offset + CacheLineSize - 1) & ~static_cast<std::uint64_t>(CacheLineSize - 1); }
+};
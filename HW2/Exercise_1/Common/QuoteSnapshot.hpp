@@ -0,0 +1,21 @@
+// Layout of the latest-quote snapshot shared by one Writer and any number of read-only Readers.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Messages.hpp"
+#include "Platform.hpp"
+#include "SharedSnapshot.hpp"
+
+// Name of the shared memory object holding the snapshot.
+const char* const QuoteSnapshotName = "MyQuoteSnapshot";
+
+// Everything placed in the mapped region, constructed by the Writer with placement new.
+struct QuoteBoard
+{
+    alignas(CacheLineSize) std::atomic<std::uint32_t> writerReady{0}; // Set by the Writer once the layout is constructed.
+    std::atomic<std::uint32_t> writerDone{0};  // Set by the Writer after its last update.
+    SharedSnapshot<Quote> quote;
+};
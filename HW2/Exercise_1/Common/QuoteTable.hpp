@@ -0,0 +1,211 @@
+// Open-addressed table of latest quotes keyed by product ID, designed to live inside a shared mapped_region.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "Messages.hpp"
+#include "Platform.hpp"
+
+// 32-bit FNV-1a hash of a product ID. Never returns 0, which marks an empty slot.
+inline std::uint32_t HashProductId(std::string_view id)
+{
+    std::uint32_t hash = 2166136261u;
+    for (char c : id)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+/**
+ * Latest quote for each of up to Capacity product IDs (as returned by Product::GetProductId()), from one writer to
+ * any number of readers.
+ * Each slot is exactly one cache line holding the key, its hash and the quote, protected by its own seqlock, so a
+ * lookup is one hash plus (at low load) one cache line read, and updating one product never disturbs readers of
+ * another. Keys are only ever added, by the writer, with linear probing; a slot's key never changes once visible.
+ * Keep the load factor at or below 1/2 so that probe sequences stay short. Readers never write, so they can map the
+ * region read_only.
+ */
+template <std::size_t Capacity>
+class QuoteTable
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Longest product ID that fits in a slot.
+    static constexpr std::size_t MaxKeyLength = 23;
+
+    // Index of a product's slot. Stable for the life of the table, so hot paths can look a key up once.
+    typedef std::uint32_t Handle;
+    static constexpr Handle NotFound = 0xFFFFFFFFu;
+
+    QuoteTable() : size(0) {}
+
+    QuoteTable(const QuoteTable&) = delete;
+    QuoteTable& operator=(const QuoteTable&) = delete;
+
+    // Writer: return the product's handle, adding the product with an empty quote if it is new.
+    // Throws std::invalid_argument if the ID is too long and std::length_error if the table is full.
+    Handle Insert(std::string_view id)
+    {
+        if (id.size() > MaxKeyLength)
+        {
+            throw std::invalid_argument("Product ID too long for the quote table: " + std::string(id));
+        }
+        const std::uint32_t hash = HashProductId(id);
+        for (std::size_t probe = 0, i = hash & (Capacity - 1); probe < Capacity; probe++, i = (i + 1) & (Capacity - 1))
+        {
+            Slot& slot = slots[i];
+            const std::uint32_t slotHash = slot.hash.load(std::memory_order_relaxed);
+            if (slotHash == 0)
+            {
+                // Fill in the key first; storing the hash with release makes the slot visible to readers.
+                std::memset(slot.key, 0, sizeof(slot.key));
+                std::memcpy(slot.key, id.data(), id.size());
+                slot.hash.store(hash, std::memory_order_release);
+                size.store(size.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                return static_cast<Handle>(i);
+            }
+            if (slotHash == hash && id == slot.key)
+            {
+                return static_cast<Handle>(i);
+            }
+        }
+        throw std::length_error("Quote table is full");
+    }
+
+    // Writer: publish a new quote for the product. The quote's updateNumber is ignored; readers see the slot's version.
+    void Update(Handle handle, const Quote& quote)
+    {
+        Slot& slot = slots[handle];
+        const std::uint32_t s = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.fields.publishTimeNs = quote.publishTimeNs;
+        slot.fields.bid = quote.bid;
+        slot.fields.ask = quote.ask;
+        slot.fields.bidSize = quote.bidSize;
+        slot.fields.askSize = quote.askSize;
+        slot.sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Writer: add the product if needed and publish its quote.
+    Handle Publish(std::string_view id, const Quote& quote)
+    {
+        Handle handle = Insert(id);
+        Update(handle, quote);
+        return handle;
+    }
+
+    // Reader: find the product's handle, or NotFound.
+    Handle Find(std::string_view id) const
+    {
+        if (id.size() > MaxKeyLength)
+        {
+            return NotFound;
+        }
+        const std::uint32_t hash = HashProductId(id);
+        for (std::size_t probe = 0, i = hash & (Capacity - 1); probe < Capacity; probe++, i = (i + 1) & (Capacity - 1))
+        {
+            const Slot& slot = slots[i];
+            const std::uint32_t slotHash = slot.hash.load(std::memory_order_acquire);
+            if (slotHash == 0)
+            {
+                return NotFound;
+            }
+            if (slotHash == hash && id == slot.key)
+            {
+                return static_cast<Handle>(i);
+            }
+        }
+        return NotFound;
+    }
+
+    // Reader: copy a consistent quote for the handle, retrying while the writer is mid-update.
+    // updateNumber is set to the number of updates the product has had. Optionally counts the retries.
+    Quote Read(Handle handle, std::uint64_t* retries = nullptr) const
+    {
+        const Slot& slot = slots[handle];
+        Quote quote;
+        for (unsigned attempt = 1;; attempt++)
+        {
+            const std::uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0)
+            {
+                quote.updateNumber = before / 2;
+                quote.publishTimeNs = slot.fields.publishTimeNs;
+                quote.bid = slot.fields.bid;
+                quote.ask = slot.fields.ask;
+                quote.bidSize = slot.fields.bidSize;
+                quote.askSize = slot.fields.askSize;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == before)
+                {
+                    return quote;
+                }
+            }
+            if (retries)
+            {
+                (*retries)++;
+            }
+            if (attempt % 64 == 0)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                CpuRelax();
+            }
+        }
+    }
+
+    // Reader: look the product up and copy its quote. False if the product is not in the table.
+    bool Lookup(std::string_view id, Quote& quote, std::uint64_t* retries = nullptr) const
+    {
+        const Handle handle = Find(id);
+        if (handle == NotFound)
+        {
+            return false;
+        }
+        quote = Read(handle, retries);
+        return true;
+    }
+
+    // Number of products in the table.
+    std::size_t Size() const { return size.load(std::memory_order_acquire); }
+
+    static constexpr std::size_t GetCapacity() { return Capacity; }
+
+private:
+    // Quote fields stored in a slot; the update count comes from the slot's sequence.
+    struct Fields
+    {
+        std::uint64_t publishTimeNs;
+        double bid;
+        double ask;
+        std::uint32_t bidSize;
+        std::uint32_t askSize;
+    };
+
+    struct alignas(CacheLineSize) Slot
+    {
+        std::atomic<std::uint32_t> hash{0};     // HashProductId of the key, 0 while the slot is empty.
+        std::atomic<std::uint32_t> sequence{0}; // Seqlock: odd while the writer is updating the fields.
+        char key[MaxKeyLength + 1] = {};        // NUL-padded product ID.
+        Fields fields = {};
+    };
+
+    static_assert(sizeof(Slot) == CacheLineSize, "A lookup should touch a single cache line");
+
+    alignas(CacheLineSize) std::atomic<std::uint32_t> size;
+    Slot slots[Capacity];
+};
@@ -0,0 +1,149 @@
+// Options that take page faults and TLB misses off the hot path: huge pages, pre-faulting and locking shared regions.
+
+#pragma once
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "CommandLine.hpp"
+
+/**
+ * What to do to a shared region right after mapping it, before the hot path starts.
+ * By default a mapped_region uses 4K pages that are faulted in lazily, so the first touch of every page on the hot
+ * path takes a page fault, and a multi-megabyte ring needs hundreds of TLB entries.
+ */
+struct RegionTuning
+{
+    bool hugePages = false; // Ask for transparent huge pages (madvise MADV_HUGEPAGE).
+    bool prefault = false;  // Touch every page now so the hot path never faults.
+    bool lock = false;      // mlock the region so it is never paged out (implies faulting it in).
+};
+
+// Read --huge, --prefault and --mlock from the command line.
+inline RegionTuning GetRegionTuning(int argc, char* argv[])
+{
+    RegionTuning tuning;
+    tuning.hugePages = HasFlag(argc, argv, "--huge");
+    tuning.prefault = HasFlag(argc, argv, "--prefault");
+    tuning.lock = HasFlag(argc, argv, "--mlock");
+    return tuning;
+}
+
+// Kilobytes of the mapping starting at address that the kernel currently backs with huge pages, from /proc/self/smaps.
+inline std::size_t HugePageKb(const void* address)
+{
+    char start[32];
+    std::snprintf(start, sizeof(start), "%lx-", reinterpret_cast<unsigned long>(address));
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool inRegion = false;
+    std::size_t kb = 0;
+    while (std::getline(smaps, line))
+    {
+        if (line.find('-') != std::string::npos && line.find(':') > line.find(' '))
+        {
+            inRegion = line.compare(0, std::strlen(start), start) == 0; // A new mapping's header line.
+        }
+        else if (inRegion && (line.compare(0, 15, "ShmemPmdMapped:") == 0 || line.compare(0, 14, "FilePmdMapped:") == 0
+                              || line.compare(0, 14, "AnonHugePages:") == 0))
+        {
+            std::istringstream fields(line.substr(line.find(':') + 1));
+            std::size_t value = 0;
+            fields >> value;
+            kb += value;
+        }
+    }
+    return kb;
+}
+
+// Apply the tuning to a freshly mapped region and say what took effect. Failures are reported, not fatal.
+// Pre-faulting a writable region uses an atomic add of zero per page, which forces a write fault without changing
+// data another process may already be writing; a read-only region is touched with plain reads.
+inline void TuneRegion(boost::interprocess::mapped_region& region, const RegionTuning& tuning)
+{
+    char* address = static_cast<char*>(region.get_address());
+    const std::size_t size = region.get_size();
+    const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+    if (tuning.hugePages)
+    {
+#if defined(MADV_HUGEPAGE)
+        // Shared memory only gets huge pages if /sys/kernel/mm/transparent_hugepage/shmem_enabled allows it.
+        if (madvise(address, size, MADV_HUGEPAGE) != 0)
+        {
+            std::perror("madvise(MADV_HUGEPAGE)");
+        }
+#else
+        std::cerr << "Transparent huge pages are not supported on this platform" << std::endl;
+#endif
+    }
+    if (tuning.prefault)
+    {
+        if (region.get_mode() == boost::interprocess::read_only)
+        {
+            volatile char sink = 0;
+            for (std::size_t offset = 0; offset < size; offset += pageSize)
+            {
+                sink = sink + address[offset];
+            }
+        }
+        else
+        {
+            for (std::size_t offset = 0; offset < size; offset += pageSize)
+            {
+                __atomic_fetch_add(address + offset, 0, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    if (tuning.lock && mlock(address, size) != 0)
+    {
+        std::perror("mlock (raise the limit with ulimit -l)");
+    }
+
+    if (tuning.hugePages || tuning.prefault || tuning.lock)
+    {
+        std::cout << "Region of " << size / 1024 << " KB:" << (tuning.hugePages ? " huge pages requested," : "")
+                  << (tuning.prefault ? " pre-faulted," : "") << (tuning.lock ? " locked," : "") << " "
+                  << HugePageKb(address) << " KB on huge pages" << std::endl;
+    }
+}
+
+/**
+ * Counts the page faults this process takes from construction onwards, so a mode can report how many faults hit its
+ * hot path. Minor faults map a page that is already in memory; major faults had to wait for I/O.
+ */
+class PageFaultCounter
+{
+public:
+    PageFaultCounter() : minorStart(0), majorStart(0) { Restart(); }
+
+    void Restart()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        minorStart = usage.ru_minflt;
+        majorStart = usage.ru_majflt;
+    }
+
+    void Print(std::ostream& out, const std::string& label) const
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        out << label << ": " << usage.ru_minflt - minorStart << " minor, " << usage.ru_majflt - majorStart << " major" << std::endl;
+    }
+
+private:
+    long minorStart;
+    long majorStart;
+};
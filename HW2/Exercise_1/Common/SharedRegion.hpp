@@ -0,0 +1,59 @@
+// Helpers for creating and opening the named shared memory objects used by the Writer and Reader.
+
+#pragma once
+
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Remove a named shared memory object on construction and destruction.
+struct SharedMemoryRemover
+{
+    explicit SharedMemoryRemover(const char* name) : name(name)
+    {
+        boost::interprocess::shared_memory_object::remove(name);
+    }
+    ~SharedMemoryRemover()
+    {
+        boost::interprocess::shared_memory_object::remove(name);
+    }
+
+    const char* name;
+};
+
+// Open a shared memory object created by the Writer, waiting until the Writer has created it.
+inline boost::interprocess::shared_memory_object OpenWhenCreated(const char* name, boost::interprocess::mode_t mode)
+{
+    while (true)
+    {
+        try
+        {
+            return boost::interprocess::shared_memory_object(boost::interprocess::open_only, name, mode);
+        }
+        catch (const boost::interprocess::interprocess_exception&)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+// Wait until the Writer has sized the object to hold at least minSize bytes, so that it can be mapped.
+inline void WaitForSize(const boost::interprocess::shared_memory_object& shm, boost::interprocess::offset_t minSize)
+{
+    boost::interprocess::offset_t size = 0;
+    while (!shm.get_size(size) || size < minSize)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Wait until the Writer has finished constructing the shared layout and raised its ready flag.
+template <typename Flag>
+void WaitForFlag(const Flag& flag)
+{
+    while (flag.load(std::memory_order_acquire) == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,154 @@
+// Lock-free slab allocator for variable-size messages, designed to live inside a shared mapped_region.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Platform.hpp"
+
+/**
+ * Hands out blocks of an arena embedded in the allocator itself, in power-of-two size classes from 64 bytes to 64 KB.
+ * Blocks are named by offset handles rather than pointers, because each process maps the region at its own address;
+ * Get turns a handle into a pointer in the calling process.
+ * Every size class has a Treiber free list whose head packs the first block's offset with a tag that changes on every
+ * push and pop, so a stale compare-and-swap (the ABA problem) always fails. Fresh blocks are carved from the arena with
+ * one fetch_add. Any process may allocate or free, with no locks and no system calls; arena memory is never returned,
+ * only recycled within its size class.
+ */
+template <std::size_t ArenaBytes>
+class SharedSlabAllocator
+{
+    static_assert(ArenaBytes % CacheLineSize == 0 && ArenaBytes < 0xFFFFFFFFull, "Offsets must fit in 32 bits");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Free list heads must be lock-free to be shared across processes");
+
+public:
+    typedef std::uint32_t Handle;
+    static constexpr Handle NullHandle = 0xFFFFFFFFu;
+
+    static constexpr std::size_t MinBlockSize = 64;
+    static constexpr std::size_t SizeClassCount = 11; // 64 B .. 64 KB
+    static constexpr std::size_t MaxAllocation = (MinBlockSize << (SizeClassCount - 1)) - 8;
+
+    SharedSlabAllocator() : carved(0)
+    {
+        for (std::size_t i = 0; i < SizeClassCount; i++)
+        {
+            freeLists[i].head.store(Pack(NullHandle, 0), std::memory_order_relaxed);
+        }
+    }
+
+    SharedSlabAllocator(const SharedSlabAllocator&) = delete;
+    SharedSlabAllocator& operator=(const SharedSlabAllocator&) = delete;
+
+    // Allocate a block with room for at least size bytes. NullHandle if size exceeds MaxAllocation or the arena and
+    // the size class's free list are both exhausted (the caller can retry once a consumer frees something).
+    Handle Allocate(std::size_t size)
+    {
+        const int sizeClass = SizeClassOf(size);
+        if (sizeClass < 0)
+        {
+            return NullHandle;
+        }
+        Handle block = Pop(freeLists[sizeClass]);
+        if (block == NullHandle)
+        {
+            const std::uint64_t blockSize = BlockSize(sizeClass);
+            const std::uint64_t offset = carved.fetch_add(blockSize, std::memory_order_relaxed);
+            if (offset + blockSize > ArenaBytes)
+            {
+                return NullHandle; // The unused tail of the arena is abandoned; other size classes keep recycling.
+            }
+            block = static_cast<Handle>(offset);
+            HeaderOf(block).sizeClass = static_cast<std::uint32_t>(sizeClass);
+        }
+        return block;
+    }
+
+    // Return a block to its size class. May be called by a different process from the one that allocated it.
+    void Free(Handle block)
+    {
+        Push(freeLists[HeaderOf(block).sizeClass], block);
+    }
+
+    // Address of the block's usable bytes in the calling process.
+    void* Get(Handle block) { return arena + block + sizeof(BlockHeader); }
+    const void* Get(Handle block) const { return arena + block + sizeof(BlockHeader); }
+
+    // Usable bytes in the block.
+    std::size_t Capacity(Handle block) const { return BlockSize(HeaderOf(block).sizeClass) - sizeof(BlockHeader); }
+
+    // Bytes of the arena carved into blocks so far (blocks on free lists included).
+    std::size_t Carved() const
+    {
+        const std::uint64_t c = carved.load(std::memory_order_relaxed);
+        return c < ArenaBytes ? static_cast<std::size_t>(c) : ArenaBytes;
+    }
+
+    static constexpr std::size_t GetArenaBytes() { return ArenaBytes; }
+
+private:
+    // Eight bytes in front of every block's usable space.
+    struct BlockHeader
+    {
+        std::atomic<std::uint32_t> next; // Next free block while on a free list.
+        std::uint32_t sizeClass;         // Set when the block is carved; never changes.
+    };
+
+    struct alignas(CacheLineSize) FreeList
+    {
+        std::atomic<std::uint64_t> head; // Tag in the high 32 bits, offset of the first free block in the low 32.
+    };
+
+    static std::uint64_t Pack(Handle block, std::uint32_t tag) { return (static_cast<std::uint64_t>(tag) << 32) | block; }
+    static Handle OffsetOf(std::uint64_t head) { return static_cast<Handle>(head & 0xFFFFFFFFu); }
+    static std::uint32_t TagOf(std::uint64_t head) { return static_cast<std::uint32_t>(head >> 32); }
+
+    static std::uint64_t BlockSize(std::uint32_t sizeClass) { return static_cast<std::uint64_t>(MinBlockSize) << sizeClass; }
+
+    // Smallest size class whose blocks hold size bytes after the header, or -1 if none does.
+    static int SizeClassOf(std::size_t size)
+    {
+        for (std::size_t i = 0; i < SizeClassCount; i++)
+        {
+            if (size + sizeof(BlockHeader) <= BlockSize(static_cast<std::uint32_t>(i)))
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    BlockHeader& HeaderOf(Handle block) { return *reinterpret_cast<BlockHeader*>(arena + block); }
+    const BlockHeader& HeaderOf(Handle block) const { return *reinterpret_cast<const BlockHeader*>(arena + block); }
+
+    void Push(FreeList& list, Handle block)
+    {
+        std::uint64_t head = list.head.load(std::memory_order_relaxed);
+        do
+        {
+            HeaderOf(block).next.store(OffsetOf(head), std::memory_order_relaxed);
+        } while (!list.head.compare_exchange_weak(head, Pack(block, TagOf(head) + 1), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Handle Pop(FreeList& list)
+    {
+        std::uint64_t head = list.head.load(std::memory_order_acquire);
+        while (OffsetOf(head) != NullHandle)
+        {
+            // The block may be popped and reused concurrently, making next stale; the tag then makes the CAS fail.
+            // Reading it is still safe because arena memory stays mapped for the allocator's lifetime.
+            const Handle next = HeaderOf(OffsetOf(head)).next.load(std::memory_order_relaxed);
+            if (list.head.compare_exchange_weak(head, Pack(next, TagOf(head) + 1), std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return OffsetOf(head);
+            }
+        }
+        return NullHandle;
+    }
+
+    FreeList freeLists[SizeClassCount];
+    alignas(CacheLineSize) std::atomic<std::uint64_t> carved; // Bump pointer into the arena.
+    alignas(CacheLineSize) char arena[ArenaBytes];
+};
@@ -0,0 +1,83 @@
+// Seqlock-protected latest-value snapshot designed to live inside a shared mapped_region.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "Platform.hpp"
+
+/**
+ * Publishes the latest value of a trivially copyable struct from one writer to any number of readers.
+ * The writer bumps a sequence counter to odd, copies the value, and bumps it back to even; it never waits.
+ * Readers copy the value between two reads of the counter and retry if it was odd or changed, so they never see a
+ * torn value and never write to shared memory (they can map the region read_only).
+ */
+template <typename T>
+class SharedSnapshot
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Snapshots are copied between processes");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The sequence must be lock-free to be shared across processes");
+
+public:
+    SharedSnapshot() : sequence(0), value() {}
+
+    SharedSnapshot(const SharedSnapshot&) = delete;
+    SharedSnapshot& operator=(const SharedSnapshot&) = delete;
+
+    // Writer: replace the published value. Only one process may store.
+    void Store(const T& newValue)
+    {
+        const std::uint64_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&value, &newValue, sizeof(T));
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Reader: one attempt to copy a consistent value. False if the writer was mid-update.
+    bool TryLoad(T& out) const
+    {
+        const std::uint64_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            return false;
+        }
+        std::memcpy(&out, &value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Reader: copy a consistent value, retrying while the writer is mid-update. Optionally counts the retries.
+    // If the writer seems descheduled mid-update, yield so it can finish rather than spinning out our time slice.
+    T Load(std::uint64_t* retries = nullptr) const
+    {
+        T out;
+        for (unsigned attempt = 1; !TryLoad(out); attempt++)
+        {
+            if (retries)
+            {
+                (*retries)++;
+            }
+            if (attempt % 64 == 0)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                CpuRelax();
+            }
+        }
+        return out;
+    }
+
+    // Number of completed stores; readers can compare versions to skip work when nothing changed.
+    std::uint64_t Version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    alignas(CacheLineSize) std::atomic<std::uint64_t> sequence;
+    T value;
+};
@@ -0,0 +1,112 @@
+// Single-producer/single-consumer ring buffer designed to live inside a mapped_region shared by two processes.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "Platform.hpp"
+
+/**
+ * Fixed-capacity SPSC queue of trivially copyable items.
+ * The producer owns tail and the consumer owns head; each index sits on its own cache line together with that
+ * side's cached copy of the other index, so the two processes only exchange a cache line when one of them
+ * actually runs out of room or data. Indices are free-running 64-bit counters and never wrap in practice.
+ * Construct it with placement new in the region the producer creates; the consumer only casts the address.
+ */
+template <typename T, std::size_t Capacity>
+class SpscRingBuffer
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "Items are copied between processes");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Indices must be lock-free to be shared across processes");
+
+public:
+    SpscRingBuffer() : head(0), cachedTail(0), tail(0), cachedHead(0) {}
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Producer: push one item; false if the ring is full.
+    bool TryPush(const T& item)
+    {
+        return PushBatch(&item, 1) == 1;
+    }
+
+    // Producer: push up to count items and publish them with a single release store. Returns the number pushed.
+    std::size_t PushBatch(const T* items, std::size_t count)
+    {
+        const std::uint64_t t = tail.load(std::memory_order_relaxed);
+        std::size_t space = Capacity - static_cast<std::size_t>(t - cachedHead);
+        if (space < count)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            space = Capacity - static_cast<std::size_t>(t - cachedHead);
+        }
+        if (count > space)
+        {
+            count = space;
+        }
+        for (std::size_t i = 0; i < count; i++)
+        {
+            slots[(t + i) & (Capacity - 1)] = items[i];
+        }
+        if (count > 0)
+        {
+            tail.store(t + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Consumer: pop one item; false if the ring is empty.
+    bool TryPop(T& item)
+    {
+        return PopBatch(&item, 1) == 1;
+    }
+
+    // Consumer: pop up to maxCount items and release their slots with a single store. Returns the number popped.
+    std::size_t PopBatch(T* items, std::size_t maxCount)
+    {
+        const std::uint64_t h = head.load(std::memory_order_relaxed);
+        std::size_t available = static_cast<std::size_t>(cachedTail - h);
+        if (available < maxCount)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            available = static_cast<std::size_t>(cachedTail - h);
+        }
+        if (maxCount > available)
+        {
+            maxCount = available;
+        }
+        for (std::size_t i = 0; i < maxCount; i++)
+        {
+            items[i] = slots[(h + i) & (Capacity - 1)];
+        }
+        if (maxCount > 0)
+        {
+            head.store(h + maxCount, std::memory_order_release);
+        }
+        return maxCount;
+    }
+
+    // Approximate number of queued items; exact only when called by one side while the other is idle.
+    std::size_t Size() const
+    {
+        return static_cast<std::size_t>(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+
+    static constexpr std::size_t GetCapacity() { return Capacity; }
+
+private:
+    // Consumer-owned cache line.
+    alignas(CacheLineSize) std::atomic<std::uint64_t> head;
+    std::uint64_t cachedTail;
+
+    // Producer-owned cache line.
+    alignas(CacheLineSize) std::atomic<std::uint64_t> tail;
+    std::uint64_t cachedHead;
+
+    alignas(CacheLineSize) T slots[Capacity];
+};
@@ -0,0 +1,149 @@
+// Ways for a shared-memory consumer to wait for the producer: busy-spin, spin-then-yield, or block on a futex.
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Platform.hpp"
+
+/**
+ * Word in shared memory that the producer rings after publishing and consumers wait on.
+ * The producer only makes a system call when some consumer is actually asleep in the kernel.
+ */
+struct Doorbell
+{
+    alignas(CacheLineSize) std::atomic<std::uint32_t> sequence{0}; // Bumped on every Notify.
+    std::atomic<std::uint32_t> sleepers{0}; // Consumers blocked in FUTEX_WAIT on sequence.
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "The doorbell must be lock-free to be shared across processes");
+
+// How a consumer waits for the doorbell to ring.
+enum WaitMode
+{
+    BUSY_SPIN,       // Lowest latency; burns a whole core while idle.
+    SPIN_THEN_YIELD, // Spin briefly, then hand the core to the scheduler between checks.
+    FUTEX_BLOCK      // Spin briefly, then sleep in the kernel until the producer wakes us; no CPU while idle.
+};
+
+// Parse "spin", "yield" or "futex".
+inline WaitMode ParseWaitMode(const std::string& name)
+{
+    if (name == "spin")
+    {
+        return BUSY_SPIN;
+    }
+    if (name == "yield")
+    {
+        return SPIN_THEN_YIELD;
+    }
+    if (name == "futex")
+    {
+        return FUTEX_BLOCK;
+    }
+    throw std::invalid_argument("Unknown wait strategy: " + name);
+}
+
+inline const char* ToString(WaitMode mode)
+{
+    switch (mode)
+    {
+    case BUSY_SPIN: return "spin";
+    case SPIN_THEN_YIELD: return "yield";
+    case FUTEX_BLOCK: return "futex";
+    default: return "";
+    }
+}
+
+/**
+ * Consumer-side wait with the same API for every WaitMode.
+ * Wait returns once the doorbell's sequence differs from the value the caller last saw; callers read the sequence
+ * before checking their queue, so a notification that races with the check is never missed.
+ */
+class WaitStrategy
+{
+public:
+    explicit WaitStrategy(WaitMode mode, unsigned spinLimit = 100) : mode(mode), spinLimit(spinLimit) {}
+
+    WaitMode GetMode() const { return mode; }
+
+    // Consumer: wait until the doorbell has rung since `seen` was read. Returns the new sequence.
+    std::uint32_t Wait(Doorbell& bell, std::uint32_t seen) const
+    {
+        std::uint32_t current;
+        for (unsigned spins = 0; mode == BUSY_SPIN || spins < spinLimit; spins++)
+        {
+            current = bell.sequence.load(std::memory_order_acquire);
+            if (current != seen)
+            {
+                return current;
+            }
+            CpuRelax();
+        }
+
+        if (mode == SPIN_THEN_YIELD)
+        {
+            while ((current = bell.sequence.load(std::memory_order_acquire)) == seen)
+            {
+                std::this_thread::yield();
+            }
+            return current;
+        }
+
+        // FUTEX_BLOCK: announce ourselves before the final check so that the producer's Notify cannot slip between
+        // the check and the sleep (the kernel re-checks the value atomically as well).
+        bell.sleepers.fetch_add(1, std::memory_order_seq_cst);
+        while ((current = bell.sequence.load(std::memory_order_seq_cst)) == seen)
+        {
+            FutexWait(bell.sequence, seen);
+        }
+        bell.sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return current;
+    }
+
+    // Producer: ring the doorbell after publishing. Enters the kernel only if a consumer is asleep.
+    static void Notify(Doorbell& bell)
+    {
+        bell.sequence.fetch_add(1, std::memory_order_seq_cst);
+        if (bell.sleepers.load(std::memory_order_seq_cst) > 0)
+        {
+            FutexWakeAll(bell.sequence);
+        }
+    }
+
+private:
+    // Shared (not FUTEX_PRIVATE) futex operations, so they work across processes mapping the same page.
+    static void FutexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+#else
+        (void)word;
+        (void)expected;
+        std::this_thread::yield();
+#endif
+    }
+
+    static void FutexWakeAll(std::atomic<std::uint32_t>& word)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+        (void)word;
+#endif
+    }
+
+    WaitMode mode;
+    unsigned spinLimit;
+};
@@ -0,0 +1,22 @@
+// Layout of the wakeup benchmark shared by the Writer (which rings) and the Reader (which waits).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Platform.hpp"
+#include "WaitStrategy.hpp"
+
+// Name of the shared memory object holding the doorbell.
+const char* const WakeupBoardName = "MyWakeupBoard";
+
+// Everything placed in the mapped region, constructed by the Writer with placement new.
+struct WakeupBoard
+{
+    alignas(CacheLineSize) std::atomic<std::uint32_t> writerReady{0}; // Set by the Writer once the layout is constructed.
+    std::atomic<std::uint32_t> readerAttached{0}; // Set by the Reader once it is about to wait.
+    std::atomic<std::uint32_t> writerDone{0};     // Set by the Writer before its final ring.
+    alignas(CacheLineSize) std::atomic<std::uint64_t> pingTimeNs{0}; // When the Writer rang the doorbell last.
+    Doorbell doorbell;
+};
@@ -0,0 +1,265 @@
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "CommandLine.hpp"
+#include "LatencyHistogram.hpp"
+#include "Messages.hpp"
+#include "SharedRegion.hpp"
+#include "SpscRingBuffer.hpp"
+#include "WaitStrategy.hpp"
+
+using namespace boost::interprocess; // For notational convenience.
+
+// Name of the shared memory object holding the two rings.
+const char* const PingPongName = "MyPingPong";
+
+// One direction of the shared-memory path: the same ring and doorbell the Writer and Reader use.
+struct ShmChannel
+{
+    Doorbell doorbell;
+    SpscRingBuffer<PriceUpdate, 1024> ring;
+};
+
+// Everything placed in the mapped region. It is mapped before forking, so both processes inherit the mapping.
+struct PingPongRegion
+{
+    ShmChannel ping; // Initiator to echoer.
+    ShmChannel pong; // Echoer to initiator.
+};
+
+// One process's end of the shared-memory path.
+class ShmEndpoint
+{
+public:
+    ShmEndpoint(ShmChannel& in, ShmChannel& out, const WaitStrategy& waiter) : in(in), out(out), waiter(waiter) {}
+
+    void Send(const PriceUpdate& update)
+    {
+        while (!out.ring.TryPush(update))
+        {
+            CpuRelax();
+        }
+        WaitStrategy::Notify(out.doorbell);
+    }
+
+    void Receive(PriceUpdate& update)
+    {
+        std::uint32_t seen = in.doorbell.sequence.load(std::memory_order_acquire);
+        while (!in.ring.TryPop(update))
+        {
+            seen = waiter.Wait(in.doorbell, seen);
+        }
+    }
+
+private:
+    ShmChannel& in;
+    ShmChannel& out;
+    WaitStrategy waiter;
+};
+
+// One process's end of a pipe pair or a socket: blocking read and write system calls.
+class FdEndpoint
+{
+public:
+    FdEndpoint(int in, int out) : in(in), out(out) {}
+
+    void Send(const PriceUpdate& update)
+    {
+        const char* data = reinterpret_cast<const char*>(&update);
+        for (std::size_t written = 0; written < sizeof(update);)
+        {
+            ssize_t n = write(out, data + written, sizeof(update) - written);
+            if (n < 0 && errno != EINTR)
+            {
+                std::perror("write");
+                std::exit(1);
+            }
+            written += n > 0 ? static_cast<std::size_t>(n) : 0;
+        }
+    }
+
+    void Receive(PriceUpdate& update)
+    {
+        char* data = reinterpret_cast<char*>(&update);
+        for (std::size_t received = 0; received < sizeof(update);)
+        {
+            ssize_t n = read(in, data + received, sizeof(update) - received);
+            if (n == 0 || (n < 0 && errno != EINTR))
+            {
+                std::perror("read");
+                std::exit(1);
+            }
+            received += n > 0 ? static_cast<std::size_t>(n) : 0;
+        }
+    }
+
+private:
+    int in;
+    int out;
+};
+
+// Pin the calling process to one core; a negative core leaves it to the scheduler.
+void PinToCore(int core)
+{
+    if (core < 0)
+    {
+        return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+    {
+        std::perror("sched_setaffinity");
+    }
+}
+
+// Fork an echoer on echoCore that bounces every message straight back, then time warmup + count round trips from
+// initiatorCore. Only the last count round trips are recorded.
+template <typename Endpoint>
+LatencyHistogram PingPong(Endpoint initiator, Endpoint echoer, std::uint64_t count, std::uint64_t warmup, int initiatorCore,
+                          int echoCore)
+{
+    const std::uint64_t total = warmup + count;
+    pid_t child = fork();
+    if (child < 0)
+    {
+        std::perror("fork");
+        std::exit(1);
+    }
+    if (child == 0)
+    {
+        PinToCore(echoCore);
+        PriceUpdate update;
+        for (std::uint64_t i = 0; i < total; i++)
+        {
+            echoer.Receive(update);
+            echoer.Send(update);
+        }
+        _exit(0);
+    }
+
+    PinToCore(initiatorCore);
+    LatencyHistogram roundTrip;
+    PriceUpdate update = {};
+    for (std::uint64_t i = 0; i < total; i++)
+    {
+        update.sequence = i;
+        update.publishTimeNs = NowNs();
+        initiator.Send(update);
+        initiator.Receive(update);
+        if (i >= warmup)
+        {
+            roundTrip.Record(NowNs() - update.publishTimeNs);
+        }
+    }
+    waitpid(child, nullptr, 0);
+    return roundTrip;
+}
+
+LatencyHistogram RunShm(std::uint64_t count, std::uint64_t warmup, int initiatorCore, int echoCore, const WaitStrategy& waiter)
+{
+    SharedMemoryRemover remover(PingPongName);
+    shared_memory_object shm(create_only, PingPongName, read_write);
+    shm.truncate(sizeof(PingPongRegion));
+    mapped_region region(shm, read_write);
+    PingPongRegion* rings = new (region.get_address()) PingPongRegion;
+
+    return PingPong(ShmEndpoint(rings->pong, rings->ping, waiter), ShmEndpoint(rings->ping, rings->pong, waiter), count, warmup,
+                    initiatorCore, echoCore);
+}
+
+LatencyHistogram RunPipe(std::uint64_t count, std::uint64_t warmup, int initiatorCore, int echoCore)
+{
+    int ping[2];
+    int pong[2];
+    if (pipe(ping) != 0 || pipe(pong) != 0)
+    {
+        std::perror("pipe");
+        std::exit(1);
+    }
+    LatencyHistogram roundTrip =
+        PingPong(FdEndpoint(pong[0], ping[1]), FdEndpoint(ping[0], pong[1]), count, warmup, initiatorCore, echoCore);
+    close(ping[0]);
+    close(ping[1]);
+    close(pong[0]);
+    close(pong[1]);
+    return roundTrip;
+}
+
+LatencyHistogram RunSocket(std::uint64_t count, std::uint64_t warmup, int initiatorCore, int echoCore)
+{
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+    {
+        std::perror("socketpair");
+        std::exit(1);
+    }
+    LatencyHistogram roundTrip =
+        PingPong(FdEndpoint(sockets[0], sockets[0]), FdEndpoint(sockets[1], sockets[1]), count, warmup, initiatorCore, echoCore);
+    close(sockets[0]);
+    close(sockets[1]);
+    return roundTrip;
+}
+
+// PingPong: round-trip latency of the shared-memory path compared with a pipe and a Unix domain socket.
+// The program forks into an initiator and an echoer, optionally pinned to two cores, and bounces a 40-byte PriceUpdate
+// between them.
+//
+// Usage: PingPong [--transport all|shm|pipe|socket] [--count N] [--warmup N] [--cores A,B] [--wait spin|yield|futex]
+//   --transport which paths to measure (default all)
+//   --count     timed round trips per transport (default 1,000,000)
+//   --warmup    untimed round trips first (default 10,000)
+//   --cores     cores for the initiator and the echoer, e.g. 2,3 (default: unpinned)
+//   --wait      shared memory: how each side waits for the other (default spin; use yield or futex with fewer than
+//               two free cores)
+int main(int argc, char* argv[])
+{
+    const std::string transport = GetOption(argc, argv, "--transport", std::string("all"));
+    const std::uint64_t count = GetOption(argc, argv, "--count", 1000000LL);
+    const std::uint64_t warmup = GetOption(argc, argv, "--warmup", 10000LL);
+    const std::string cores = GetOption(argc, argv, "--cores", std::string());
+    const WaitStrategy waiter(ParseWaitMode(GetOption(argc, argv, "--wait", std::string("spin"))));
+
+    int initiatorCore = -1;
+    int echoCore = -1;
+    if (!cores.empty() && std::sscanf(cores.c_str(), "%d,%d", &initiatorCore, &echoCore) != 2)
+    {
+        std::cerr << "--cores expects two core numbers, e.g. 2,3" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Round trips: " << count << " (after " << warmup << " warmup), cores: "
+              << (cores.empty() ? std::string("unpinned") : cores) << std::endl;
+
+    if (transport == "all" || transport == "shm")
+    {
+        LatencyHistogram roundTrip = RunShm(count, warmup, initiatorCore, echoCore, waiter);
+        roundTrip.Print(std::cout, std::string("Shared memory (") + ToString(waiter.GetMode()) + ") round trip");
+        roundTrip.PrintDistribution(std::cout, "Shared memory round-trip distribution");
+    }
+    if (transport == "all" || transport == "pipe")
+    {
+        LatencyHistogram roundTrip = RunPipe(count, warmup, initiatorCore, echoCore);
+        roundTrip.Print(std::cout, "Pipe round trip");
+        roundTrip.PrintDistribution(std::cout, "Pipe round-trip distribution");
+    }
+    if (transport == "all" || transport == "socket")
+    {
+        LatencyHistogram roundTrip = RunSocket(count, warmup, initiatorCore, echoCore);
+        roundTrip.Print(std::cout, "Unix socket round trip");
+        roundTrip.PrintDistribution(std::cout, "Unix socket round-trip distribution");
+    }
+
+    return 0;
+}
@@ -1,25 +1,550 @@
-#include <boost/interprocess/shared_memory_object.hpp>
-#include <boost/interprocess/mapped_region.hpp>
-#include <iostream>
-
-using namespace boost::interprocess; // For notational convenience.
-
-int main()
-{
-    // Open the shared memory object.
-    shared_memory_object shm(open_only, "MySharedMemory", read_only);
-
-    // Map the whole shared memory in this process.
-    mapped_region region(shm, read_only);
-
-    // Get the address of the mapped region.
-    const void* addr = region.get_address();
-
-    // Obtain the shared data.
-    const int* shared_data = static_cast<const int*>(addr);
-
-    // Print the data from the shared memory.
-    std::cout << "Data read from shared memory: " << *shared_data << std::endl;
-
-    return 0;
-}
\ No newline at end of file
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandLine.hpp"
+#include "Journal.hpp"
+#include "LatencyHistogram.hpp"
+#include "MessageArena.hpp"
+#include "PriceBroadcast.hpp"
+#include "PriceFeed.hpp"
+#include "ProductQuotes.hpp"
+#include "ProductUniverse.hpp"
+#include "QuoteSnapshot.hpp"
+#include "RegionTuning.hpp"
+#include "SharedRegion.hpp"
+#include "WaitStrategy.hpp"
+#include "Wakeup.hpp"
+
+using namespace boost::interprocess; // For notational convenience.
+
+void ReportThroughput(std::uint64_t received, std::uint64_t start)
+{
+    const double seconds = static_cast<double>(NowNs() - start) / 1e9;
+    std::cout << "Received " << received << " updates in " << seconds << " s: "
+              << static_cast<double>(received) / seconds / 1e6 << " M updates/s" << std::endl;
+}
+
+// Consume the Writer's SPSC stream, waiting on the feed's doorbell whenever the ring is empty.
+int RunSpsc(std::size_t batch, const WaitStrategy& waiter, const RegionTuning& tuning)
+{
+    // Open the shared memory object, waiting for the Writer to create and size it.
+    shared_memory_object shm = OpenWhenCreated(PriceFeedName, read_write);
+    WaitForSize(shm, sizeof(PriceFeed));
+
+    // Map the whole shared memory in this process. The consumer writes the ring's read index, so it maps read_write.
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+
+    // Obtain the shared feed and tell the Writer we are ready.
+    PriceFeed* feed = static_cast<PriceFeed*>(region.get_address());
+    WaitForFlag(feed->writerReady);
+    feed->readerAttached.store(1, std::memory_order_release);
+
+    std::vector<PriceUpdate> updates(batch);
+    LatencyHistogram latency;
+    std::uint64_t received = 0;
+    std::uint64_t gaps = 0;
+    std::uint64_t start = 0;
+    bool done = false;
+    // Read the doorbell before checking the ring, so that a batch pushed in between still wakes us.
+    std::uint32_t seen = feed->doorbell.sequence.load(std::memory_order_acquire);
+    PageFaultCounter faults;
+    while (!done)
+    {
+        std::size_t n = feed->ring.PopBatch(updates.data(), batch);
+        if (n == 0)
+        {
+            seen = waiter.Wait(feed->doorbell, seen);
+            continue;
+        }
+        const std::uint64_t now = NowNs();
+        if (received == 0)
+        {
+            start = now;
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const PriceUpdate& update = updates[i];
+            if (update.sequence != received)
+            {
+                gaps++;
+            }
+            received = update.sequence + 1;
+            latency.Record(now - update.publishTimeNs);
+            done = done || (update.flags & LAST_UPDATE) != 0;
+        }
+    }
+    ReportThroughput(received, start);
+    std::cout << "Sequence gaps: " << gaps << std::endl;
+    latency.Print(std::cout, "Publish-to-consume latency");
+    faults.Print(std::cout, "Page faults while consuming");
+
+    return 0;
+}
+
+// Consume the Writer's broadcast as one of several independent Readers.
+int RunBroadcast(std::size_t batch, const std::string& name, const WaitStrategy& waiter, const RegionTuning& tuning)
+{
+    shared_memory_object shm = OpenWhenCreated(PriceBroadcastName, read_write);
+    WaitForSize(shm, sizeof(PriceBroadcast));
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    PriceBroadcast* broadcast = static_cast<PriceBroadcast*>(region.get_address());
+    WaitForFlag(broadcast->writerReady);
+
+    // Registering makes this Reader visible to the Writer, which starts publishing once everyone is attached.
+    PriceBroadcastReader reader(broadcast->ring, name.c_str());
+
+    std::vector<PriceUpdate> updates(batch);
+    LatencyHistogram latency;
+    std::uint64_t received = 0;
+    std::uint64_t lost = 0;
+    std::uint64_t start = 0;
+    bool done = false;
+    std::uint32_t seen = broadcast->doorbell.sequence.load(std::memory_order_acquire);
+    PageFaultCounter faults;
+    while (!done)
+    {
+        std::size_t n = reader.Poll(updates.data(), batch);
+        if (n == 0)
+        {
+            if (reader.Overrun())
+            {
+                // Too slow: the Writer lapped us. Skip to the live end rather than reading overwritten data.
+                lost += reader.Resync();
+                continue;
+            }
+            if (broadcast->writerDone.load(std::memory_order_acquire) && reader.Lag() == 0)
+            {
+                break; // Resynced past the last update.
+            }
+            seen = waiter.Wait(broadcast->doorbell, seen);
+            continue;
+        }
+        const std::uint64_t now = NowNs();
+        if (received == 0)
+        {
+            start = now;
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            latency.Record(now - updates[i].publishTimeNs);
+            done = done || (updates[i].flags & LAST_UPDATE) != 0;
+        }
+        received += n;
+    }
+    ReportThroughput(received, start);
+    std::cout << "Reader '" << name << "' lost " << lost << " updates to overruns" << std::endl;
+    latency.Print(std::cout, "Publish-to-consume latency");
+    faults.Print(std::cout, "Page faults while consuming");
+
+    return 0;
+}
+
+// Poll the latest quote until the Writer is done, checking every copy for tearing.
+int RunSnapshot(const RegionTuning& tuning)
+{
+    // Seqlock readers never write, so the region is mapped read-only.
+    shared_memory_object shm = OpenWhenCreated(QuoteSnapshotName, read_only);
+    WaitForSize(shm, sizeof(QuoteBoard));
+    mapped_region region(shm, read_only);
+    TuneRegion(region, tuning);
+    const QuoteBoard* board = static_cast<const QuoteBoard*>(region.get_address());
+    WaitForFlag(board->writerReady);
+
+    LatencyHistogram loadLatency;
+    LatencyHistogram staleness;
+    std::uint64_t reads = 0;
+    std::uint64_t retries = 0;
+    std::uint64_t changes = 0;
+    std::uint64_t torn = 0;
+    std::uint64_t lastUpdate = 0;
+    PageFaultCounter faults;
+    bool done = false;
+    while (!done)
+    {
+        // Check the flag before reading so that the final quote is always read once more after the Writer finishes.
+        done = board->writerDone.load(std::memory_order_acquire) != 0;
+
+        const std::uint64_t before = NowNs();
+        const Quote quote = board->quote.Load(&retries);
+        const std::uint64_t after = NowNs();
+        loadLatency.Record(after - before);
+        reads++;
+
+        if (quote.updateNumber != 0 && (quote.ask - quote.bid != 1.0 / 128.0 || quote.bidSize != quote.askSize))
+        {
+            torn++;
+        }
+        if (quote.updateNumber != lastUpdate)
+        {
+            changes++;
+            lastUpdate = quote.updateNumber;
+            staleness.Record(after - quote.publishTimeNs);
+        }
+    }
+
+    std::cout << "Reads: " << reads << ", retries: " << retries << ", quote changes seen: " << changes
+              << ", last update: " << lastUpdate << ", torn reads: " << torn << std::endl;
+    loadLatency.Print(std::cout, "Snapshot load time");
+    staleness.Print(std::cout, "Publish-to-read latency of new quotes");
+    faults.Print(std::cout, "Page faults while reading");
+
+    return 0;
+}
+
+// Look up the latest quote of random products by ID until the Writer is done, checking every copy for tearing.
+int RunTable(const RegionTuning& tuning)
+{
+    shared_memory_object shm = OpenWhenCreated(ProductQuotesName, read_only);
+    WaitForSize(shm, sizeof(ProductQuotes));
+    mapped_region region(shm, read_only);
+    TuneRegion(region, tuning);
+    const ProductQuotes* quotes = static_cast<const ProductQuotes*>(region.get_address());
+    WaitForFlag(quotes->writerReady);
+
+    // The IDs a pricer would hold, e.g. from Product::GetProductId().
+    const std::uint32_t products = quotes->productCount.load(std::memory_order_relaxed);
+    std::vector<std::string> ids(products);
+    for (std::uint32_t i = 0; i < products; i++)
+    {
+        ids[i] = MakeProductId(i);
+    }
+
+    LatencyHistogram lookupLatency;
+    std::uint64_t lookups = 0;
+    std::uint64_t missing = 0;
+    std::uint64_t retries = 0;
+    std::uint64_t torn = 0;
+    std::uint64_t random = 88172645463325252ull;
+    PageFaultCounter faults;
+    const std::uint64_t start = NowNs();
+    bool done = false;
+    while (!done)
+    {
+        done = quotes->writerDone.load(std::memory_order_acquire) != 0;
+        for (int i = 0; i < 1024; i++)
+        {
+            // xorshift64 picks the next product.
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            const std::string& id = ids[random % products];
+
+            Quote quote;
+            const std::uint64_t before = NowNs();
+            const bool found = quotes->table.Lookup(id, quote, &retries);
+            lookupLatency.Record(NowNs() - before);
+            lookups++;
+
+            if (!found)
+            {
+                missing++;
+            }
+            else if (quote.updateNumber != 0 && (quote.ask - quote.bid != 1.0 / 128.0 || quote.bidSize != quote.askSize))
+            {
+                torn++;
+            }
+        }
+    }
+    const double seconds = static_cast<double>(NowNs() - start) / 1e9;
+
+    std::cout << "Lookups: " << lookups << " over " << products << " products in " << seconds << " s ("
+              << static_cast<double>(lookups) / seconds / 1e6 << " M lookups/s), retries: " << retries
+              << ", missing: " << missing << ", torn reads: " << torn << std::endl;
+    lookupLatency.Print(std::cout, "Lookup time");
+    faults.Print(std::cout, "Page faults while reading");
+
+    return 0;
+}
+
+// Replay a journal written by the Writer, either as fast as memory allows or at the pace it was recorded.
+int RunReplay(const std::string& path, std::size_t batch, bool paced)
+{
+    JournalReader journal(path);
+
+    LatencyHistogram lateness; // Paced replay: how far behind the recorded schedule each update was delivered.
+    std::uint64_t records = 0;
+    std::uint64_t gaps = 0;
+    std::uint64_t expected = 0;
+    double checksum = 0;
+    std::uint64_t firstPublishNs = 0;
+    PageFaultCounter faults;
+    const std::uint64_t start = NowNs();
+    std::size_t n;
+    while (const PriceUpdate* updates = journal.Next(batch, n))
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const PriceUpdate& update = updates[i];
+            if (paced)
+            {
+                if (records == 0)
+                {
+                    firstPublishNs = update.publishTimeNs;
+                }
+                // Wait until the update is as far into the replay as it was into the recording.
+                const std::uint64_t due = start + (update.publishTimeNs - firstPublishNs);
+                std::uint64_t now = NowNs();
+                while (now < due)
+                {
+                    CpuRelax();
+                    now = NowNs();
+                }
+                lateness.Record(now - due);
+            }
+            if (update.sequence != expected)
+            {
+                gaps++;
+            }
+            expected = update.sequence + 1;
+            checksum += update.bid + update.ask;
+            records++;
+        }
+    }
+    const double seconds = static_cast<double>(NowNs() - start) / 1e9;
+
+    std::cout << "Replayed " << records << " updates from " << journal.Segment() + 1 << " segment(s) in " << seconds << " s: "
+              << static_cast<double>(records) / seconds / 1e6 << " M updates/s, "
+              << static_cast<double>(records * sizeof(PriceUpdate)) / seconds / 1e6 << " MB/s" << std::endl;
+    std::cout << "Sequence gaps: " << gaps << ", checksum: " << checksum << std::endl;
+    if (paced)
+    {
+        lateness.Print(std::cout, "Delivery behind recorded pace");
+    }
+    faults.Print(std::cout, "Page faults while replaying");
+
+    return 0;
+}
+
+// Read variable-size messages in place through the handles the Writer queues, verify them, and free their blocks.
+int RunMessages(std::size_t batch, const WaitStrategy& waiter, const RegionTuning& tuning)
+{
+    shared_memory_object shm = OpenWhenCreated(MessageArenaName, read_write);
+    WaitForSize(shm, sizeof(MessageArena));
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    MessageArena* arena = static_cast<MessageArena*>(region.get_address());
+    WaitForFlag(arena->writerReady);
+    arena->readerAttached.store(1, std::memory_order_release);
+
+    std::vector<MessageRef> refs(batch);
+    LatencyHistogram latency;
+    std::uint64_t received = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t corrupt = 0;
+    std::uint64_t gaps = 0;
+    std::uint64_t start = 0;
+    bool done = false;
+    std::uint32_t seen = arena->doorbell.sequence.load(std::memory_order_acquire);
+    PageFaultCounter faults;
+    while (!done)
+    {
+        std::size_t n = arena->ring.PopBatch(refs.data(), batch);
+        if (n == 0)
+        {
+            seen = waiter.Wait(arena->doorbell, seen);
+            continue;
+        }
+        const std::uint64_t now = NowNs();
+        if (received == 0)
+        {
+            start = now;
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const unsigned char* body = static_cast<const unsigned char*>(arena->allocator.Get(refs[i].handle));
+            const VariableMessageHeader* header = reinterpret_cast<const VariableMessageHeader*>(body);
+            std::uint32_t checksum = 0;
+            for (std::uint32_t b = 0; b < header->length; b++)
+            {
+                checksum += body[sizeof(VariableMessageHeader) + b];
+            }
+            corrupt += checksum != header->checksum || sizeof(VariableMessageHeader) + header->length != refs[i].length;
+            gaps += header->sequence != received;
+            received = header->sequence + 1;
+            bytes += refs[i].length;
+            latency.Record(now - header->publishTimeNs);
+            done = done || (header->flags & LAST_UPDATE) != 0;
+
+            // Hand the block back; the Writer will reuse it for a later message of the same size class.
+            arena->allocator.Free(refs[i].handle);
+        }
+    }
+    const double seconds = static_cast<double>(NowNs() - start) / 1e9;
+    std::cout << "Received " << received << " messages in " << seconds << " s: " << static_cast<double>(received) / seconds / 1e6
+              << " M messages/s, " << static_cast<double>(bytes) / seconds / 1e6 << " MB/s" << std::endl;
+    std::cout << "Sequence gaps: " << gaps << ", corrupt messages: " << corrupt << std::endl;
+    latency.Print(std::cout, "Publish-to-consume latency");
+    faults.Print(std::cout, "Page faults while consuming");
+
+    return 0;
+}
+
+// Query the Writer's flat product universe in place, without copying or deserialising it.
+int RunProducts(const RegionTuning& tuning)
+{
+    shared_memory_object shm = OpenWhenCreated(ProductUniverseName, read_write);
+    WaitForSize(shm, sizeof(ProductUniverse));
+    mapped_region region(shm, read_write); // read_write only so that the Reader can say when it is done.
+    TuneRegion(region, tuning);
+    ProductUniverse* universe = static_cast<ProductUniverse*>(region.get_address());
+    WaitForFlag(universe->writerReady);
+
+    // Scan the fixed-size records directly: string fields are compared in place and dates are plain integers.
+    const std::int32_t cutoff = ToDaySerial(date(2030, Jan, 1));
+    std::uint64_t treasuries = 0;
+    std::uint64_t longBonds = 0;
+    std::uint64_t longUsdSwaps = 0;
+    std::uint64_t euroDollars = 0;
+    PageFaultCounter faults;
+    const std::uint64_t start = NowNs();
+    const FlatBond* bonds = universe->Bonds();
+    for (std::uint32_t i = 0; i < universe->bondCount; i++)
+    {
+        treasuries += std::strcmp(bonds[i].ticker, "T") == 0;
+        longBonds += bonds[i].maturityDate >= cutoff;
+    }
+    const FlatIRSwap* swaps = universe->Swaps();
+    for (std::uint32_t i = 0; i < universe->swapCount; i++)
+    {
+        longUsdSwaps += swaps[i].currency == USD && swaps[i].termYears > 5;
+    }
+    const FlatFuture* futures = universe->Futures();
+    for (std::uint32_t i = 0; i < universe->futureCount; i++)
+    {
+        euroDollars += futures[i].kind == EURODOLLAR_FUTURE;
+    }
+    const double seconds = static_cast<double>(NowNs() - start) / 1e9;
+    const std::uint64_t scanned = static_cast<std::uint64_t>(universe->bondCount) + universe->swapCount + universe->futureCount;
+    const std::uint64_t bytes = universe->bondCount * sizeof(FlatBond) + universe->swapCount * sizeof(FlatIRSwap)
+                                + universe->futureCount * sizeof(FlatFuture);
+
+    std::cout << "Scanned " << scanned << " products in place in " << seconds * 1e3 << " ms ("
+              << static_cast<double>(bytes) / seconds / 1e6 << " MB/s)" << std::endl;
+    std::cout << "Bonds with ticker T: " << treasuries << ", maturing in 2030 or later: " << longBonds
+              << "; USD swaps longer than 5y: " << longUsdSwaps << "; EuroDollar futures: " << euroDollars << std::endl;
+    faults.Print(std::cout, "Page faults while scanning");
+
+    // Rich objects are only rebuilt for the products actually needed.
+    if (universe->bondCount > 0)
+    {
+        std::cout << "First bond: " << FromFlat(bonds[0]) << std::endl;
+    }
+    if (universe->swapCount > 0)
+    {
+        std::cout << "First swap: " << FromFlat(swaps[0]) << std::endl;
+    }
+    const FlatFuture* euroDollar = std::find_if(futures, futures + universe->futureCount,
+                                                [](const FlatFuture& future) { return future.kind == EURODOLLAR_FUTURE; });
+    if (euroDollar != futures + universe->futureCount)
+    {
+        std::cout << "First EuroDollar future: " << ToEuroDollarFuture(*euroDollar) << std::endl;
+    }
+
+    universe->readersDone.fetch_add(1, std::memory_order_acq_rel);
+
+    return 0;
+}
+
+// Measure how long the chosen wait strategy takes to notice the Writer's doorbell, and what waiting costs in CPU.
+int RunWakeup(const WaitStrategy& waiter, const RegionTuning& tuning)
+{
+    shared_memory_object shm = OpenWhenCreated(WakeupBoardName, read_write);
+    WaitForSize(shm, sizeof(WakeupBoard));
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    WakeupBoard* board = static_cast<WakeupBoard*>(region.get_address());
+    WaitForFlag(board->writerReady);
+
+    LatencyHistogram wakeup;
+    std::uint32_t seen = board->doorbell.sequence.load(std::memory_order_acquire);
+    board->readerAttached.store(1, std::memory_order_release);
+
+    const std::uint64_t wallStart = NowNs();
+    const std::uint64_t cpuStart = CpuTimeNs();
+    PageFaultCounter faults;
+    while (true)
+    {
+        seen = waiter.Wait(board->doorbell, seen);
+        const std::uint64_t now = NowNs();
+        if (board->writerDone.load(std::memory_order_acquire))
+        {
+            break;
+        }
+        wakeup.Record(now - board->pingTimeNs.load(std::memory_order_relaxed));
+    }
+    const double wallSeconds = static_cast<double>(NowNs() - wallStart) / 1e9;
+    const double cpuSeconds = static_cast<double>(CpuTimeNs() - cpuStart) / 1e9;
+
+    std::cout << "Wait strategy '" << ToString(waiter.GetMode()) << "': " << wakeup.Count() << " wakeups, CPU " << cpuSeconds
+              << " s over " << wallSeconds << " s (" << 100.0 * cpuSeconds / wallSeconds << "% of a core)" << std::endl;
+    wakeup.Print(std::cout, "Ring-to-wake latency");
+    faults.Print(std::cout, "Page faults while waiting");
+
+    return 0;
+}
+
+// Reader: a consumer process. Reads price updates published by the Writer and reports throughput and latency.
+//
+// Usage: Reader [--mode spsc|broadcast|snapshot|table|products|messages|wakeup|replay] [--batch N] [--name NAME] [--wait spin|yield|futex]
+//               [--journal PATH] [--paced] [--huge] [--prefault] [--mlock]
+//   --mode   spsc: sole consumer of the SPSC ring (default); broadcast: one of several broadcast Readers;
+//            snapshot: one of any number of read-only Readers of the latest quote; table: one of any number of
+//            read-only Readers looking up quotes by product ID; products: query the flat product universe in place;
+//            messages: variable-size messages from the shared slab allocator; wakeup: doorbell latency benchmark;
+//            replay: read back a journal written by the Writer (no Writer needed)
+//   --batch  maximum updates taken per ring operation (default 64)
+//   --name   broadcast mode: name this Reader registers under (default "reader")
+//   --wait   spsc, broadcast, messages and wakeup modes: how to wait for the Writer; spin burns a core, yield spins briefly
+//            then yields (default), futex spins briefly then sleeps in the kernel
+//   --journal replay mode: path the Writer was given with --journal
+//   --paced  replay mode: deliver updates at the pace they were recorded instead of as fast as possible
+//   --huge, --prefault, --mlock: as for the Writer, applied to this process's mapping of the region
+int main(int argc, char* argv[])
+{
+    const std::string mode = GetOption(argc, argv, "--mode", std::string("spsc"));
+    const std::size_t batch = GetOption(argc, argv, "--batch", 64LL);
+    const RegionTuning tuning = GetRegionTuning(argc, argv);
+    const WaitStrategy waiter(ParseWaitMode(GetOption(argc, argv, "--wait", std::string("yield"))));
+
+    if (mode == "spsc")
+    {
+        return RunSpsc(batch, waiter, tuning);
+    }
+    if (mode == "broadcast")
+    {
+        return RunBroadcast(batch, GetOption(argc, argv, "--name", std::string("reader")), waiter, tuning);
+    }
+    if (mode == "snapshot")
+    {
+        return RunSnapshot(tuning);
+    }
+    if (mode == "table")
+    {
+        return RunTable(tuning);
+    }
+    if (mode == "products")
+    {
+        return RunProducts(tuning);
+    }
+    if (mode == "messages")
+    {
+        return RunMessages(batch, waiter, tuning);
+    }
+    if (mode == "wakeup")
+    {
+        return RunWakeup(waiter, tuning);
+    }
+    if (mode == "replay")
+    {
+        return RunReplay(GetOption(argc, argv, "--journal", std::string("prices.journal")), batch, HasFlag(argc, argv, "--paced"));
+    }
+    std::cerr << "Unknown mode: " << mode << std::endl;
+    return 1;
+}
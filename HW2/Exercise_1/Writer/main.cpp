@@ -1,52 +1,556 @@
-#include <boost/interprocess/shared_memory_object.hpp>
-#include <boost/interprocess/mapped_region.hpp>
-#include <iostream>
-#include <string>
-
-using namespace boost::interprocess; // For notational convenience.
-
-int main()
-{
-    // Remove shared memory on construction and destruction.
-    struct shm_remove
-    {
-        shm_remove()
-        {
-            shared_memory_object::remove("MySharedMemory");
-        }
-        ~shm_remove()
-        {
-            shared_memory_object::remove("MySharedMemory");
-        }
-    } remover;
-
-    // Create a shared memory object.
-    shared_memory_object shm(create_only, "MySharedMemory", read_write);
-
-    // Set the size of the shared memory object. We only need to hold an int.
-    shm.truncate(sizeof(int));
-
-    // Map the whole shared memory in this process.
-    mapped_region region(shm, read_write);
-
-    // Get the address of the mapped region.
-    void* addr = region.get_address();
-
-    // Construct the shared structure in memory.
-    int* shared_data = new (addr) int;
-
-    // Write data to the shared memory.
-    *shared_data = 123;
-
-    std::cout << "Data written to shared memory: " << *shared_data << std::endl;
-
-    // Wait for specific user input before exiting.
-    std::string input;
-    std::cout << "Enter 'exit' to finish: ";
-    while (input != "exit")
-    {
-        std::getline(std::cin, input);
-    }
-
-    return 0;
-}
\ No newline at end of file
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandLine.hpp"
+#include "Journal.hpp"
+#include "LatencyHistogram.hpp"
+#include "MessageArena.hpp"
+#include "PriceBroadcast.hpp"
+#include "PriceFeed.hpp"
+#include "ProductQuotes.hpp"
+#include "ProductUniverse.hpp"
+#include "QuoteSnapshot.hpp"
+#include "RegionTuning.hpp"
+#include "SharedRegion.hpp"
+#include "Wakeup.hpp"
+
+using namespace boost::interprocess; // For notational convenience.
+
+// Fill the update with the given sequence number out of count, stamped with the publish time.
+void FillUpdate(PriceUpdate& update, std::uint64_t sequence, std::uint64_t count, std::uint64_t now)
+{
+    update.sequence = sequence;
+    update.publishTimeNs = now;
+    update.productIndex = static_cast<std::uint32_t>(sequence % 1000);
+    update.flags = sequence + 1 == count ? static_cast<std::uint32_t>(LAST_UPDATE) : 0u;
+    update.bid = 99.0 + static_cast<double>(sequence % 64) / 256.0;
+    update.ask = update.bid + 1.0 / 128.0;
+}
+
+// Spin until the given sequence is due at the requested rate (no-op when rate is 0).
+void Pace(std::uint64_t start, std::uint64_t sequence, std::uint64_t rate)
+{
+    if (rate > 0)
+    {
+        const std::uint64_t due = start + sequence * 1000000000ull / rate;
+        while (NowNs() < due)
+        {
+            CpuRelax();
+        }
+    }
+}
+
+void ReportThroughput(std::uint64_t count, std::uint64_t start)
+{
+    const double seconds = static_cast<double>(NowNs() - start) / 1e9;
+    std::cout << "Published " << count << " updates in " << seconds << " s: " << static_cast<double>(count) / seconds / 1e6
+              << " M updates/s, " << static_cast<double>(count * sizeof(PriceUpdate)) / seconds / 1e6 << " MB/s" << std::endl;
+}
+
+// Where to build the next batch of n updates: directly in the journal if there is one, so journaling costs no extra
+// copy, otherwise in the scratch buffer. n shrinks if the journal segment has less room left.
+PriceUpdate* ClaimBatch(JournalWriter* journal, std::vector<PriceUpdate>& scratch, std::size_t& n)
+{
+    return journal ? journal->Claim(n) : scratch.data();
+}
+
+void ReportJournal(const JournalWriter* journal)
+{
+    if (journal)
+    {
+        std::cout << "Journaled " << journal->Records() << " updates in " << journal->Segments() << " segment(s)" << std::endl;
+    }
+}
+
+// Stream updates to a single Reader through the SPSC ring, journaling them first if journal is not null.
+int RunSpsc(std::uint64_t count, std::size_t batch, std::uint64_t rate, JournalWriter* journal, const RegionTuning& tuning)
+{
+    SharedMemoryRemover remover(PriceFeedName);
+
+    // Create a shared memory object sized for the feed.
+    shared_memory_object shm(create_only, PriceFeedName, read_write);
+    shm.truncate(sizeof(PriceFeed));
+
+    // Map the whole shared memory in this process.
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+
+    // Construct the shared structure in memory.
+    PriceFeed* feed = new (region.get_address()) PriceFeed;
+    feed->writerReady.store(1, std::memory_order_release);
+
+    // Wait for the Reader so that it sees the stream from the start.
+    std::cout << "Waiting for the Reader to attach..." << std::endl;
+    WaitForFlag(feed->readerAttached);
+
+    std::cout << "Publishing " << count << " updates in batches of " << batch << std::endl;
+    std::vector<PriceUpdate> updates(batch);
+    PageFaultCounter faults;
+    const std::uint64_t start = NowNs();
+    std::uint64_t sequence = 0;
+    while (sequence < count)
+    {
+        Pace(start, sequence, rate);
+        std::size_t n = count - sequence < batch ? static_cast<std::size_t>(count - sequence) : batch;
+        PriceUpdate* batchUpdates = ClaimBatch(journal, updates, n);
+        const std::uint64_t now = NowNs();
+        for (std::size_t i = 0; i < n; i++)
+        {
+            FillUpdate(batchUpdates[i], sequence + i, count, now);
+        }
+        if (journal)
+        {
+            journal->Commit(n);
+        }
+
+        // Push the whole batch, yielding while the ring is full.
+        std::size_t pushed = 0;
+        while (pushed < n)
+        {
+            std::size_t done = feed->ring.PushBatch(&batchUpdates[pushed], n - pushed);
+            pushed += done;
+            if (done == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        WaitStrategy::Notify(feed->doorbell);
+        sequence += n;
+    }
+    ReportThroughput(count, start);
+    faults.Print(std::cout, "Page faults while publishing");
+    ReportJournal(journal);
+
+    return 0;
+}
+
+// Broadcast updates to every attached Reader without ever waiting for them, journaling them first if journal is not null.
+int RunBroadcast(std::uint64_t count, std::size_t batch, std::uint64_t rate, std::size_t readers, JournalWriter* journal,
+                 const RegionTuning& tuning)
+{
+    SharedMemoryRemover remover(PriceBroadcastName);
+
+    shared_memory_object shm(create_only, PriceBroadcastName, read_write);
+    shm.truncate(sizeof(PriceBroadcast));
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    PriceBroadcast* broadcast = new (region.get_address()) PriceBroadcast;
+    broadcast->writerReady.store(1, std::memory_order_release);
+    PriceBroadcastRing& ring = broadcast->ring;
+
+    // Wait for the expected number of Readers to register.
+    std::cout << "Waiting for " << readers << " Reader(s) to attach..." << std::endl;
+    std::size_t attached = 0;
+    while (attached < readers)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        attached = 0;
+        for (std::size_t i = 0; i < ring.GetMaxReaders(); i++)
+        {
+            attached += ring.GetReaderStatus(i).active.load(std::memory_order_acquire);
+        }
+    }
+
+    std::cout << "Broadcasting " << count << " updates in batches of " << batch << std::endl;
+    std::vector<PriceUpdate> updates(batch);
+    PageFaultCounter faults;
+    const std::uint64_t start = NowNs();
+    std::uint64_t sequence = 0;
+    while (sequence < count)
+    {
+        Pace(start, sequence, rate);
+        std::size_t n = count - sequence < batch ? static_cast<std::size_t>(count - sequence) : batch;
+        PriceUpdate* batchUpdates = ClaimBatch(journal, updates, n);
+        const std::uint64_t now = NowNs();
+        for (std::size_t i = 0; i < n; i++)
+        {
+            FillUpdate(batchUpdates[i], sequence + i, count, now);
+        }
+        if (journal)
+        {
+            journal->Commit(n);
+        }
+        ring.PublishBatch(batchUpdates, n);
+        WaitStrategy::Notify(broadcast->doorbell);
+        sequence += n;
+    }
+    broadcast->writerDone.store(1, std::memory_order_release);
+    WaitStrategy::Notify(broadcast->doorbell);
+    ReportThroughput(count, start);
+    faults.Print(std::cout, "Page faults while publishing");
+    ReportJournal(journal);
+
+    // Give Readers a moment to drain, then report where each one got to.
+    const std::uint64_t deadline = NowNs() + 2000000000ull;
+    bool drained = false;
+    while (!drained && NowNs() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        drained = true;
+        for (std::size_t i = 0; i < ring.GetMaxReaders(); i++)
+        {
+            const PriceBroadcastRing::ReaderStatus& status = ring.GetReaderStatus(i);
+            if (status.active.load(std::memory_order_acquire) && status.cursor.load(std::memory_order_acquire) < count)
+            {
+                drained = false;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < ring.GetMaxReaders(); i++)
+    {
+        const PriceBroadcastRing::ReaderStatus& status = ring.GetReaderStatus(i);
+        if (status.name[0] != '\0')
+        {
+            std::cout << "Reader '" << status.name << "': cursor " << status.cursor.load() << ", overruns "
+                      << status.overruns.load() << ", updates lost " << status.lost.load() << std::endl;
+        }
+    }
+
+    return 0;
+}
+
+// Publish a stream of quote changes through a seqlocked snapshot. Readers only ever see the latest quote.
+int RunSnapshot(std::uint64_t count, std::uint64_t rate, std::uint64_t delayMs, const RegionTuning& tuning)
+{
+    SharedMemoryRemover remover(QuoteSnapshotName);
+
+    shared_memory_object shm(create_only, QuoteSnapshotName, read_write);
+    shm.truncate(sizeof(QuoteBoard));
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    QuoteBoard* board = new (region.get_address()) QuoteBoard;
+    board->writerReady.store(1, std::memory_order_release);
+
+    // Readers map the snapshot read-only and are invisible to the Writer, so give them time to start.
+    std::cout << "Publishing " << count << " quote changes in " << delayMs << " ms..." << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+
+    PageFaultCounter faults;
+    const std::uint64_t start = NowNs();
+    Quote quote;
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        Pace(start, i, rate);
+        // Every quote satisfies ask - bid == 1/128 and bidSize == askSize, so Readers can detect torn reads.
+        quote.updateNumber = i + 1;
+        quote.publishTimeNs = NowNs();
+        quote.bid = 99.0 + static_cast<double>(i % 64) / 256.0;
+        quote.ask = quote.bid + 1.0 / 128.0;
+        quote.bidSize = static_cast<std::uint32_t>(i % 1000 + 1);
+        quote.askSize = quote.bidSize;
+        board->quote.Store(quote);
+    }
+    board->writerDone.store(1, std::memory_order_release);
+    ReportThroughput(count, start);
+    faults.Print(std::cout, "Page faults while publishing");
+
+    // Leave the final quote up briefly so that Readers see the done flag before the object is removed.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    return 0;
+}
+
+// Load a universe of products into the quote table, then publish count quote changes spread across all of them.
+int RunTable(std::uint32_t products, std::uint64_t count, std::uint64_t rate, std::uint64_t delayMs,
+             const RegionTuning& tuning)
+{
+    SharedMemoryRemover remover(ProductQuotesName);
+
+    shared_memory_object shm(create_only, ProductQuotesName, read_write);
+    shm.truncate(sizeof(ProductQuotes));
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    ProductQuotes* quotes = new (region.get_address()) ProductQuotes;
+
+    // Add every product up front, keeping the handles so that the publishing loop never hashes or probes.
+    std::vector<ProductQuoteTable::Handle> handles(products);
+    for (std::uint32_t i = 0; i < products; i++)
+    {
+        handles[i] = quotes->table.Insert(MakeProductId(i));
+    }
+    quotes->productCount.store(products, std::memory_order_relaxed);
+    quotes->writerReady.store(1, std::memory_order_release);
+
+    std::cout << "Publishing " << count << " quote changes across " << products << " products in " << delayMs << " ms..." << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+
+    PageFaultCounter faults;
+    const std::uint64_t start = NowNs();
+    Quote quote;
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        Pace(start, i, rate);
+        // Scatter updates over the universe; as in snapshot mode, ask - bid == 1/128 and bidSize == askSize.
+        const std::uint32_t product = static_cast<std::uint32_t>((i * 2654435761ull) % products);
+        quote.publishTimeNs = NowNs();
+        quote.bid = 99.0 + static_cast<double>(i % 64) / 256.0;
+        quote.ask = quote.bid + 1.0 / 128.0;
+        quote.bidSize = static_cast<std::uint32_t>(i % 1000 + 1);
+        quote.askSize = quote.bidSize;
+        quotes->table.Update(handles[product], quote);
+    }
+    quotes->writerDone.store(1, std::memory_order_release);
+    ReportThroughput(count, start);
+    faults.Print(std::cout, "Page faults while publishing");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    return 0;
+}
+
+// Publish count variable-size messages: each body is allocated in the shared slab allocator and written in place, and
+// only its handle goes through the ring. The Reader frees the body after reading it.
+int RunMessages(std::uint64_t count, std::uint32_t minSize, std::uint32_t maxSize, const RegionTuning& tuning)
+{
+    SharedMemoryRemover remover(MessageArenaName);
+
+    shared_memory_object shm(create_only, MessageArenaName, read_write);
+    shm.truncate(sizeof(MessageArena));
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    MessageArena* arena = new (region.get_address()) MessageArena;
+    arena->writerReady.store(1, std::memory_order_release);
+
+    std::cout << "Waiting for the Reader to attach..." << std::endl;
+    WaitForFlag(arena->readerAttached);
+
+    std::cout << "Publishing " << count << " messages of " << minSize << " to " << maxSize << " payload bytes" << std::endl;
+    std::uint64_t random = 88172645463325252ull;
+    std::uint64_t bytes = 0;
+    std::uint64_t allocationStalls = 0;
+    PageFaultCounter faults;
+    const std::uint64_t start = NowNs();
+    for (std::uint64_t sequence = 0; sequence < count; sequence++)
+    {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        const std::uint32_t length = minSize + static_cast<std::uint32_t>(random % (maxSize - minSize + 1));
+        const std::uint32_t total = static_cast<std::uint32_t>(sizeof(VariableMessageHeader)) + length;
+
+        // Allocate the body in shared memory, waiting for the Reader to free blocks if the arena is exhausted.
+        MessageAllocator::Handle handle;
+        while ((handle = arena->allocator.Allocate(total)) == MessageAllocator::NullHandle)
+        {
+            allocationStalls++;
+            std::this_thread::yield();
+        }
+
+        // Build the message where the Reader will read it.
+        char* body = static_cast<char*>(arena->allocator.Get(handle));
+        VariableMessageHeader* header = reinterpret_cast<VariableMessageHeader*>(body);
+        const unsigned char fill = static_cast<unsigned char>(sequence);
+        std::memset(body + sizeof(VariableMessageHeader), fill, length);
+        header->sequence = sequence;
+        header->length = length;
+        header->flags = sequence + 1 == count ? static_cast<std::uint32_t>(LAST_UPDATE) : 0u;
+        header->checksum = fill * length;
+        header->reserved = 0;
+        header->publishTimeNs = NowNs();
+
+        const MessageRef ref = {handle, total};
+        while (!arena->ring.TryPush(ref))
+        {
+            std::this_thread::yield();
+        }
+        WaitStrategy::Notify(arena->doorbell);
+        bytes += total;
+    }
+    const double seconds = static_cast<double>(NowNs() - start) / 1e9;
+    std::cout << "Published " << count << " messages in " << seconds << " s: " << static_cast<double>(count) / seconds / 1e6
+              << " M messages/s, " << static_cast<double>(bytes) / seconds / 1e6 << " MB/s" << std::endl;
+    std::cout << "Allocation stalls: " << allocationStalls << ", arena carved: " << arena->allocator.Carved() / 1024 << " KB of "
+              << MessageAllocator::GetArenaBytes() / 1024 << " KB" << std::endl;
+    faults.Print(std::cout, "Page faults while publishing");
+
+    // Let the Reader drain before the object is removed.
+    while (arena->ring.Size() > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return 0;
+}
+
+// Build a universe of bonds, swaps and futures and publish it in flat form for Readers to use in place.
+int RunProducts(std::uint32_t products, std::size_t readers, const RegionTuning& tuning)
+{
+    static const char* const tickers[] = {"T", "IBM", "GE", "F", "AAPL"};
+    static const int terms[] = {1, 2, 3, 5, 7, 10, 20, 30};
+
+    SharedMemoryRemover remover(ProductUniverseName);
+
+    ProductUniverse layout;
+    const std::size_t size = layout.Layout(products, products, products);
+    shared_memory_object shm(create_only, ProductUniverseName, read_write);
+    shm.truncate(size);
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    ProductUniverse* universe = new (region.get_address()) ProductUniverse;
+    universe->Layout(products, products, products);
+
+    // Convert each rich product straight into its slot in the region.
+    const std::uint64_t start = NowNs();
+    const date firstMaturity(2025, Jan, 1);
+    const date firstEffective(2024, Jan, 2);
+    for (std::uint32_t i = 0; i < products; i++)
+    {
+        universe->Bonds()[i] = ToFlat(Bond(MakeProductId(i), CUSIP, tickers[i % 5], 0.5f + static_cast<float>(i % 40) * 0.125f,
+                                           firstMaturity + date_duration(i % 10000)));
+
+        const date effective = firstEffective + date_duration(i % 365);
+        const int term = terms[i % 8];
+        universe->Swaps()[i] = ToFlat(IRSwap("SWP" + MakeProductId(i), THIRTY_THREE_SIXTY, ACT_THREE_SIXTY, static_cast<PaymentFrequency>(i % 3),
+                                             static_cast<FloatingIndex>(i % 2), static_cast<FloatingIndexTenor>(i % 4), effective, effective + years(term),
+                                             static_cast<Currency>(i % 3), term, static_cast<SwapType>(i % 5), static_cast<SwapLegType>(i % 3)));
+
+        const std::string futureId = "FUT" + MakeProductId(i);
+        const FutureExchange exchange = static_cast<FutureExchange>(i % 5);
+        const date maturity = firstMaturity + date_duration(i % 2000);
+        switch (i % 3)
+        {
+        case 0: universe->Futures()[i] = ToFlat(Future(futureId, static_cast<FutureType>(i % 6), exchange, 1000, maturity)); break;
+        case 1: universe->Futures()[i] = ToFlat(EuroDollarFuture(futureId, exchange, 2500, maturity, 0.05f)); break;
+        default: universe->Futures()[i] = ToFlat(BondFuture(futureId, exchange, 1000, maturity, 0.06f)); break;
+        }
+    }
+    const double seconds = static_cast<double>(NowNs() - start) / 1e9;
+    universe->writerReady.store(1, std::memory_order_release);
+    std::cout << "Published " << products << " bonds, swaps and futures (" << size / 1024 << " KB) in " << seconds << " s" << std::endl;
+
+    // Keep the region alive until every Reader is done with it.
+    std::cout << "Waiting for " << readers << " Reader(s) to finish..." << std::endl;
+    while (universe->readersDone.load(std::memory_order_acquire) < readers)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return 0;
+}
+
+// Ring the Reader's doorbell count times, intervalUs apart, so that the Reader is idle before every ring and its wait
+// strategy decides how quickly it notices. Also reports what ringing costs the Writer.
+int RunWakeup(std::uint64_t count, std::uint64_t intervalUs, const RegionTuning& tuning)
+{
+    SharedMemoryRemover remover(WakeupBoardName);
+
+    shared_memory_object shm(create_only, WakeupBoardName, read_write);
+    shm.truncate(sizeof(WakeupBoard));
+    mapped_region region(shm, read_write);
+    TuneRegion(region, tuning);
+    WakeupBoard* board = new (region.get_address()) WakeupBoard;
+    board->writerReady.store(1, std::memory_order_release);
+
+    std::cout << "Waiting for the Reader to attach..." << std::endl;
+    WaitForFlag(board->readerAttached);
+
+    std::cout << "Ringing " << count << " times, " << intervalUs << " us apart" << std::endl;
+    LatencyHistogram notifyCost;
+    PageFaultCounter faults;
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+        const std::uint64_t now = NowNs();
+        board->pingTimeNs.store(now, std::memory_order_relaxed);
+        WaitStrategy::Notify(board->doorbell);
+        notifyCost.Record(NowNs() - now);
+    }
+    board->writerDone.store(1, std::memory_order_release);
+    WaitStrategy::Notify(board->doorbell);
+    notifyCost.Print(std::cout, "Notify cost");
+    faults.Print(std::cout, "Page faults while ringing");
+
+    // Keep the object alive until the Reader has seen the done flag.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    return 0;
+}
+
+// Writer: the feed process. Publishes price updates to Readers through shared memory.
+//
+// Usage: Writer [--mode spsc|broadcast|snapshot|table|products|messages|wakeup] [--count N] [--batch N] [--rate N]
+//               [--readers N] [--delay-ms N] [--products N] [--min-size N] [--max-size N] [--interval-us N] [--journal PATH] [--segment-records N] [--flush-every N]
+//               [--huge] [--prefault] [--mlock]
+//   --mode     spsc: one Reader through an SPSC ring (default); broadcast: every Reader sees every update;
+//              snapshot: Readers see the latest quote through a seqlock; table: Readers look up the latest quote of
+//              any product by ID; products: Readers use a flat bond/swap/future universe in place;
+//              messages: variable-size messages in a shared slab allocator; wakeup: doorbell latency benchmark
+//   --count    number of updates to publish (default 10,000,000; wakeup mode: number of rings, default 10,000)
+//   --batch    updates published per ring operation (default 64)
+//   --rate     target updates per second, 0 for as fast as possible (default 0)
+//   --readers  broadcast mode: number of Readers to wait for before publishing; products mode: number of Readers to
+//              wait for before removing the universe (default 1)
+//   --delay-ms snapshot and table modes: time to let Readers start before publishing (default 1000)
+//   --products table mode: number of product IDs in the table; products mode: number of each product type
+//              (default 50,000). Products mode flattens them into fixed-width records, which hold bond and future
+//              IDs of at most 15 characters, swap IDs of at most 23 and tickers of at most 7 (the generated IDs fit)
+//   --min-size, --max-size messages mode: range of payload sizes in bytes (default 16 to 1024, at most
+//              MaxMessagePayload = 65,496, so that header and payload fit in the largest 64 KB slab block)
+//   --interval-us wakeup mode: idle time before each ring (default 100)
+//   --journal  spsc and broadcast modes: also append every update to the journal PATH.000000, PATH.000001, ...
+//   --segment-records records per journal segment file (default 1,048,576, i.e. 40 MB)
+//   --flush-every     committed records between asynchronous msyncs of the journal (default 65,536)
+//   --huge     back the shared region with transparent huge pages
+//   --prefault fault the whole region in before publishing
+//   --mlock    lock the region in memory
+int main(int argc, char* argv[])
+{
+    const std::string mode = GetOption(argc, argv, "--mode", std::string("spsc"));
+    const std::uint64_t count = GetOption(argc, argv, "--count", mode == "wakeup" ? 10000LL : 10000000LL);
+    const std::size_t batch = GetOption(argc, argv, "--batch", 64LL);
+    const std::uint64_t rate = GetOption(argc, argv, "--rate", 0LL);
+    const RegionTuning tuning = GetRegionTuning(argc, argv);
+    const std::string journalPath = GetOption(argc, argv, "--journal", std::string());
+
+    std::unique_ptr<JournalWriter> journal;
+    if (!journalPath.empty() && (mode == "spsc" || mode == "broadcast"))
+    {
+        journal.reset(new JournalWriter(journalPath, GetOption(argc, argv, "--segment-records", 1LL << 20),
+                                        GetOption(argc, argv, "--flush-every", 65536LL)));
+    }
+
+    if (mode == "spsc")
+    {
+        return RunSpsc(count, batch, rate, journal.get(), tuning);
+    }
+    if (mode == "broadcast")
+    {
+        return RunBroadcast(count, batch, rate, GetOption(argc, argv, "--readers", 1LL), journal.get(), tuning);
+    }
+    if (mode == "snapshot")
+    {
+        return RunSnapshot(count, rate, GetOption(argc, argv, "--delay-ms", 1000LL), tuning);
+    }
+    if (mode == "table")
+    {
+        return RunTable(GetOption(argc, argv, "--products", 50000LL), count, rate, GetOption(argc, argv, "--delay-ms", 1000LL),
+                        tuning);
+    }
+    if (mode == "products")
+    {
+        return RunProducts(GetOption(argc, argv, "--products", 50000LL), GetOption(argc, argv, "--readers", 1LL), tuning);
+    }
+    if (mode == "messages")
+    {
+        const long long minSize = GetOption(argc, argv, "--min-size", 16LL);
+        const long long maxSize = GetOption(argc, argv, "--max-size", 1024LL);
+        if (minSize < 0 || minSize > maxSize || static_cast<unsigned long long>(maxSize) > MaxMessagePayload)
+        {
+            std::cerr << "Message sizes must satisfy 0 <= --min-size <= --max-size <= " << MaxMessagePayload << std::endl;
+            return 1;
+        }
+        return RunMessages(count, static_cast<std::uint32_t>(minSize), static_cast<std::uint32_t>(maxSize), tuning);
+    }
+    if (mode == "wakeup")
+    {
+        return RunWakeup(count, GetOption(argc, argv, "--interval-us", 100LL), tuning);
+    }
+    std::cerr << "Unknown mode: " << mode << std::endl;
+    return 1;
+}
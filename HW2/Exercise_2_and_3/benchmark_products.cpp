@@ -0,0 +1,227 @@
+/**
+ * benchmark program comparing the copying query methods of our ProductServices (vector<Bond>, vector<IRSwap>) with the
+ * view and visitor variants, counting the heap allocations and bytes each query makes, and timing the CSV bulk load
+ * and the binary snapshots
+ * usage: benchmark_products [number of swaps (default 200000)] [number of bonds (default 100000)]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include "products.hpp"
+#include "productservice.hpp"
+#include "productloader.hpp"
+#include "snapshot.hpp"
+
+using namespace std;
+
+#if defined(__GNUC__) && !defined(__clang__)
+// The replaced operators pair malloc with free; GCC flags them once inlined into standard containers
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Heap allocations made by the whole program, counted by the replaced global operator new; atomic because the CSV
+// loader allocates from several threads at once
+static atomic<size_t> allocationCount(0);
+static atomic<size_t> allocationBytes(0);
+
+void* operator new(size_t size)
+{
+  allocationCount.fetch_add(1, memory_order_relaxed);
+  allocationBytes.fetch_add(size, memory_order_relaxed);
+  void* memory = malloc(size == 0 ? 1 : size);
+  if (memory == nullptr) { throw bad_alloc(); }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+  free(memory);
+}
+
+// Run a query repetitions times and print its time, allocations and bytes per call, and the number of products it
+// visited per call. The query returns a checksum over the products it visited, so that no variant can skip the work.
+template<typename Query>
+void Measure(const string& label, int repetitions, Query query)
+{
+  const size_t countBefore = allocationCount;
+  const size_t bytesBefore = allocationBytes;
+  double checksum = 0;
+  size_t visited = 0;
+  const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++) { checksum += query(visited); }
+  const double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / repetitions;
+  cout << left << setw(52) << label << right << fixed << setprecision(1)
+       << setw(10) << micros << " us" << setw(10) << (allocationCount - countBefore) / repetitions << " allocs"
+       << setw(12) << (allocationBytes - bytesBefore) / repetitions << " bytes" << setw(9) << visited / repetitions << " products"
+       << "  (checksum " << setprecision(0) << checksum << ")" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+  const int swapCount = argc > 1 ? atoi(argv[1]) : 200000;
+  const int bondCount = argc > 2 ? atoi(argv[2]) : 100000;
+  const int repetitions = 20;
+
+  // Build a swap universe cycling through the enum values, and a bond universe with 1000 tickers
+  IRSwapProductService swapProductService;
+  for (int i = 0; i < swapCount; i++)
+  {
+    char productId[24];
+    snprintf(productId, sizeof(productId), "SWAP%08d", i);
+    IRSwap swap(productId, DayCountConvention(i % 3), DayCountConvention((i / 3) % 3), PaymentFrequency((i / 7) % 3), FloatingIndex(i % 2),
+                FloatingIndexTenor((i / 5) % 4), date(2015, Jan, 2), date(2016 + i % 30, Jan, 2), Currency((i / 11) % 3), 1 + i % 30,
+                SwapType(i % 5), SwapLegType((i / 13) % 3));
+    swapProductService.Add(swap);
+  }
+  BondProductService bondProductService;
+  for (int i = 0; i < bondCount; i++)
+  {
+    char cusip[16];
+    char ticker[8];
+    snprintf(cusip, sizeof(cusip), "B%08d", i);
+    snprintf(ticker, sizeof(ticker), "TK%03d", i % 1000);
+    Bond bond(cusip, CUSIP, ticker, 1.0f + (i % 40) * 0.125f, date(2020 + i % 30, Jun, 15));
+    bondProductService.Add(bond);
+  }
+  cout << swapCount << " swaps, " << bondCount << " bonds, " << repetitions << " repetitions per query" << endl;
+
+  // Make the lazy range indexes sort before anything is timed
+  swapProductService.ViewSwapsGreaterThan(0);
+  bondProductService.ViewBondsMaturingBetween(date(2000, Jan, 1), date(2000, Jan, 1));
+
+  Measure("GetSwaps(SPOT), copies", repetitions, [&](size_t& visited) {
+    double sum = 0;
+    vector<IRSwap> swaps = swapProductService.GetSwaps(SPOT);
+    for (auto i = swaps.begin(); i != swaps.end(); i++) { sum += i->GetTermYears(); }
+    visited += swaps.size();
+    return sum;
+  });
+  Measure("ViewSwaps(SPOT), view", repetitions, [&](size_t& visited) {
+    double sum = 0;
+    ProductView<IRSwap> swaps = swapProductService.ViewSwaps(SPOT);
+    for (auto i = swaps.begin(); i != swaps.end(); i++) { sum += i->GetTermYears(); }
+    visited += swaps.size();
+    return sum;
+  });
+
+  Measure("GetSwapsGreaterThan(5), copies", repetitions, [&](size_t& visited) {
+    double sum = 0;
+    vector<IRSwap> swaps = swapProductService.GetSwapsGreaterThan(5);
+    for (auto i = swaps.begin(); i != swaps.end(); i++) { sum += i->GetTermYears(); }
+    visited += swaps.size();
+    return sum;
+  });
+  Measure("ViewSwapsGreaterThan(5), view", repetitions, [&](size_t& visited) {
+    double sum = 0;
+    ProductView<IRSwap> swaps = swapProductService.ViewSwapsGreaterThan(5);
+    for (auto i = swaps.begin(); i != swaps.end(); i++) { sum += i->GetTermYears(); }
+    visited += swaps.size();
+    return sum;
+  });
+
+  string ticker = "TK042";
+  Measure("GetBonds(ticker), copies", repetitions * 100, [&](size_t& visited) {
+    double sum = 0;
+    vector<Bond> bonds = bondProductService.GetBonds(ticker);
+    for (auto i = bonds.begin(); i != bonds.end(); i++) { sum += i->GetCoupon(); }
+    visited += bonds.size();
+    return sum;
+  });
+  Measure("ViewBonds(ticker), view", repetitions * 100, [&](size_t& visited) {
+    double sum = 0;
+    ProductView<Bond> bonds = bondProductService.ViewBonds(ticker);
+    for (auto i = bonds.begin(); i != bonds.end(); i++) { sum += i->GetCoupon(); }
+    visited += bonds.size();
+    return sum;
+  });
+
+  // Product id lookups, the hottest reference data operation
+  vector<string> lookupIds;
+  for (int i = 0; i < 1000; i++)
+  {
+    char productId[24];
+    snprintf(productId, sizeof(productId), "SWAP%08d", (i * 7919) % swapCount);
+    lookupIds.push_back(productId);
+  }
+  Measure("1000 x Find(productId)", repetitions * 10, [&](size_t& visited) {
+    double sum = 0;
+    for (auto i = lookupIds.begin(); i != lookupIds.end(); i++)
+    {
+      const IRSwap* swap = swapProductService.Find(*i);
+      if (swap != nullptr) { sum += swap->GetTermYears(); visited++; }
+    }
+    return sum;
+  });
+
+  Measure("Query(USD, LIBOR, not IMM).Results(), pointers", repetitions, [&](size_t& visited) {
+    double sum = 0;
+    vector<const IRSwap*> swaps = swapProductService.Query().WithCurrency(USD).WithFloatingIndex(LIBOR).Not().WithSwapType(IMM).Results();
+    for (auto i = swaps.begin(); i != swaps.end(); i++) { sum += (*i)->GetTermYears(); }
+    visited += swaps.size();
+    return sum;
+  });
+  Measure("Query(USD, LIBOR, not IMM).ForEach, visitor", repetitions, [&](size_t& visited) {
+    double sum = 0;
+    swapProductService.Query().WithCurrency(USD).WithFloatingIndex(LIBOR).Not().WithSwapType(IMM).ForEach([&](const IRSwap& swap) {
+      sum += swap.GetTermYears();
+      visited++;
+    });
+    return sum;
+  });
+
+  // Bulk load of the swap universe from a CSV file, parsed by one thread and by one thread per hardware thread
+  const string csvPath = "benchmark_swaps.csv";
+  FILE* csv = fopen(csvPath.c_str(), "w");
+  if (csv == nullptr) { return 1; }
+  for (int i = 0; i < swapCount; i++)
+  {
+    fprintf(csv, "SWAP%08d,%s,%s,%s,%s,%s,2015-01-02,%d-01-02,%s,%d,%s,%s\n", i, DAY_COUNT_CONVENTION_NAMES[i % 3], DAY_COUNT_CONVENTION_NAMES[(i / 3) % 3],
+            PAYMENT_FREQUENCY_NAMES[(i / 7) % 3], FLOATING_INDEX_NAMES[i % 2], FLOATING_INDEX_TENOR_NAMES[(i / 5) % 4], 2016 + i % 30,
+            CURRENCY_NAMES[(i / 11) % 3], 1 + i % 30, SWAP_TYPE_NAMES[i % 5], SWAP_LEG_TYPE_NAMES[(i / 13) % 3]);
+  }
+  fclose(csv);
+  const unsigned threads = max(1u, thread::hardware_concurrency());
+  Measure("LoadIRSwaps(csv), 1 thread", 1, [&](size_t& visited) {
+    IRSwapProductService loaded;
+    visited += LoadIRSwaps(csvPath, loaded, 1);
+    return static_cast<double>(loaded.Query().WithSwapType(SPOT).Count());
+  });
+  Measure("LoadIRSwaps(csv), " + to_string(threads) + " threads", 1, [&](size_t& visited) {
+    IRSwapProductService loaded;
+    visited += LoadIRSwaps(csvPath, loaded, threads);
+    return static_cast<double>(loaded.Query().WithSwapType(SPOT).Count());
+  });
+  remove(csvPath.c_str());
+
+  // Binary snapshot of the swap service: save, open in place with a lookup, and restore into a new service
+  const string snapshotPath = "benchmark_swaps.snapshot";
+  Measure("SaveSnapshot(swaps)", 1, [&](size_t& visited) {
+    SaveSnapshot(swapProductService, snapshotPath);
+    visited += swapProductService.Size();
+    return 0.0;
+  });
+  Measure("ProductSnapshot(swaps) + Find, in place", 1, [&](size_t& visited) {
+    ProductSnapshot<FlatIRSwap> snapshot(snapshotPath);
+    visited += snapshot.Size();
+    return static_cast<double>(snapshot.Find("SWAP00000042")->termYears);
+  });
+  Measure("RestoreSnapshot(swaps)", 1, [&](size_t& visited) {
+    IRSwapProductService restored;
+    visited += RestoreSnapshot(snapshotPath, restored);
+    return static_cast<double>(restored.Query().WithSwapType(SPOT).Count());
+  });
+  remove(snapshotPath.c_str());
+
+  return 0;
+}
@@ -0,0 +1,526 @@
+/**
+ * bitmap.hpp defines a compressed bitmap of product ordinals (Roaring-style) used to evaluate multi-predicate
+ * product queries with word-wide AND, OR and AND NOT operations
+ */
+
+#ifndef BITMAP_HPP
+#define BITMAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include "indexsection.hpp"
+
+using namespace std;
+
+// Number of set bits in a word. Without a popcount instruction (-mpopcnt) the compiler builtin is a library call, so
+// the portable version adds bits in parallel within the word instead.
+inline unsigned BitCount(uint64_t word)
+{
+#if defined(_MSC_VER)
+	return static_cast<unsigned>(__popcnt64(word));
+#elif defined(__POPCNT__)
+	return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+	word = word - ((word >> 1) & 0x5555555555555555ull);
+	word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return static_cast<unsigned>((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Index of the lowest set bit of a non-zero word
+inline unsigned LowestBit(uint64_t word)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return static_cast<unsigned>(index);
+#else
+	return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+/**
+ * Set of 32-bit ordinals, split into chunks of 65536 by their high 16 bits like a Roaring bitmap.
+ * A chunk holding at most 4096 ordinals is a sorted array of their low 16 bits (2 bytes per ordinal); a denser chunk is
+ * a 65536-bit bitmap (8 KB, 1 bit per ordinal). Set operations on two bitmap chunks combine 64 ordinals per word
+ * operation, or 256 per instruction when compiled with AVX2; array chunks are merged or probed instead.
+ */
+class Bitmap
+{
+public:
+	// Add an ordinal; cheapest when ordinals are added in increasing order
+	void Add(uint32_t ordinal);
+
+	// Whether the ordinal is in the set
+	bool Contains(uint32_t ordinal) const;
+
+	// Number of ordinals in the set
+	size_t Cardinality() const;
+
+	// Whether the set is empty
+	bool Empty() const;
+
+	// Call f(ordinal) for every ordinal, in increasing order
+	template<typename F>
+	void ForEach(F f) const;
+
+	// Ordinals in increasing order
+	vector<uint32_t> ToVector() const;
+
+	// Keep only the ordinals also in other
+	Bitmap& operator&=(const Bitmap& other);
+
+	// Add the ordinals of other
+	Bitmap& operator|=(const Bitmap& other);
+
+	// Remove the ordinals of other
+	Bitmap& operator-=(const Bitmap& other);
+
+	// Write the chunks to a section, each as its sorted array of low bits or its 1024 words
+	void Save(SectionWriter& section) const;
+
+	// Replace the set with one written by Save, adopting its chunks as they are; throws runtime_error if the section
+	// is malformed or holds an ordinal not below limit
+	void Load(SectionReader& section, uint64_t limit);
+
+private:
+	static const uint32_t ArrayLimit = 4096; // largest array chunk; beyond it a bitmap is smaller
+	static const size_t ChunkWords = 1024; // 65536 bits, a whole number of 256-bit vectors
+
+	enum WordOp { WORD_AND, WORD_OR, WORD_ANDNOT };
+
+	struct Chunk
+	{
+		uint16_t key; // high 16 bits of the chunk's ordinals
+		uint32_t cardinality;
+		vector<uint16_t> array; // sorted low 16 bits, for an array chunk
+		vector<uint64_t> words; // ChunkWords words, for a bitmap chunk
+
+		bool IsBitmap() const { return !words.empty(); }
+	};
+
+	// Combine two bitmap chunks' words into out (which may be a), returning the number of bits set in out
+	template<WordOp Op>
+	static uint32_t CombineWords(const uint64_t* a, const uint64_t* b, uint64_t* out);
+
+	// Combine chunk b, which has the same key, into chunk a
+	static void AndChunk(Chunk& a, const Chunk& b);
+	static void OrChunk(Chunk& a, const Chunk& b);
+	static void AndNotChunk(Chunk& a, const Chunk& b);
+
+	// Set the given low bits in a bitmap chunk
+	static void SetBits(Chunk& chunk, const vector<uint16_t>& lows);
+
+	// Turn an array chunk into a bitmap chunk
+	static void ToBitmapChunk(Chunk& chunk);
+
+	// Turn a bitmap chunk holding few enough ordinals back into an array chunk
+	static void Compact(Chunk& chunk);
+
+	static bool TestBit(const vector<uint64_t>& words, uint16_t low) { return (words[low >> 6] >> (low & 63)) & 1; }
+
+	vector<Chunk> chunks; // sorted by key, never empty chunks
+
+};
+
+// Ordinals in both sets
+Bitmap And(const Bitmap& a, const Bitmap& b);
+
+// Ordinals in either set
+Bitmap Or(const Bitmap& a, const Bitmap& b);
+
+// Ordinals in a but not in b
+Bitmap AndNot(const Bitmap& a, const Bitmap& b);
+
+void Bitmap::Add(uint32_t ordinal)
+{
+	const uint16_t key = static_cast<uint16_t>(ordinal >> 16);
+	const uint16_t low = static_cast<uint16_t>(ordinal & 0xFFFF);
+
+	vector<Chunk>::iterator chunk;
+	if (!chunks.empty() && chunks.back().key == key)
+	{
+		chunk = chunks.end() - 1;
+	}
+	else
+	{
+		chunk = lower_bound(chunks.begin(), chunks.end(), key, [](const Chunk& c, uint16_t k) { return c.key < k; });
+		if (chunk == chunks.end() || chunk->key != key)
+		{
+			Chunk fresh;
+			fresh.key = key;
+			fresh.cardinality = 0;
+			chunk = chunks.insert(chunk, fresh);
+		}
+	}
+
+	if (chunk->IsBitmap())
+	{
+		uint64_t& word = chunk->words[low >> 6];
+		const uint64_t bit = uint64_t(1) << (low & 63);
+		if (!(word & bit)) { word |= bit; chunk->cardinality++; }
+		return;
+	}
+	if (chunk->array.empty() || chunk->array.back() < low)
+	{
+		chunk->array.push_back(low);
+	}
+	else
+	{
+		vector<uint16_t>::iterator it = lower_bound(chunk->array.begin(), chunk->array.end(), low);
+		if (*it == low) { return; }
+		chunk->array.insert(it, low);
+	}
+	chunk->cardinality++;
+	if (chunk->cardinality > ArrayLimit) { ToBitmapChunk(*chunk); }
+}
+
+bool Bitmap::Contains(uint32_t ordinal) const
+{
+	const uint16_t key = static_cast<uint16_t>(ordinal >> 16);
+	const uint16_t low = static_cast<uint16_t>(ordinal & 0xFFFF);
+	vector<Chunk>::const_iterator chunk = lower_bound(chunks.begin(), chunks.end(), key, [](const Chunk& c, uint16_t k) { return c.key < k; });
+	if (chunk == chunks.end() || chunk->key != key) { return false; }
+	if (chunk->IsBitmap()) { return TestBit(chunk->words, low); }
+	return binary_search(chunk->array.begin(), chunk->array.end(), low);
+}
+
+size_t Bitmap::Cardinality() const
+{
+	size_t count = 0;
+	for (vector<Chunk>::const_iterator it = chunks.begin(); it != chunks.end(); it++) { count += it->cardinality; }
+	return count;
+}
+
+bool Bitmap::Empty() const
+{
+	return chunks.empty();
+}
+
+template<typename F>
+void Bitmap::ForEach(F f) const
+{
+	for (vector<Chunk>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); chunk++)
+	{
+		const uint32_t high = static_cast<uint32_t>(chunk->key) << 16;
+		if (chunk->IsBitmap())
+		{
+			for (size_t i = 0; i < ChunkWords; i++)
+			{
+				for (uint64_t word = chunk->words[i]; word != 0; word &= word - 1)
+				{
+					f(high | static_cast<uint32_t>(i * 64 + LowestBit(word)));
+				}
+			}
+		}
+		else
+		{
+			for (vector<uint16_t>::const_iterator low = chunk->array.begin(); low != chunk->array.end(); low++) { f(high | *low); }
+		}
+	}
+}
+
+vector<uint32_t> Bitmap::ToVector() const
+{
+	vector<uint32_t> ordinals;
+	ordinals.reserve(Cardinality());
+	ForEach([&ordinals](uint32_t ordinal) { ordinals.push_back(ordinal); });
+	return ordinals;
+}
+
+void Bitmap::Save(SectionWriter& section) const
+{
+	section.Value(chunks.size());
+	for (vector<Chunk>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); chunk++)
+	{
+		section.Value(chunk->key);
+		section.Value(chunk->IsBitmap());
+		if (chunk->IsBitmap()) { section.Array(chunk->words.data(), chunk->words.size()); }
+		else { section.Array(chunk->array.data(), chunk->array.size()); }
+	}
+}
+
+// The loaded chunks must keep the invariants the set operations rely on: keys in increasing order, array chunks of 1 to
+// ArrayLimit increasing lows, bitmap chunks of more than ArrayLimit bits
+void Bitmap::Load(SectionReader& section, uint64_t limit)
+{
+	const uint64_t count = section.Value();
+	if (count > 65536) { throw runtime_error("Bitmap section has too many chunks"); }
+	vector<Chunk> loaded(static_cast<size_t>(count));
+	uint32_t highest = 0; // largest low of the last chunk
+	for (size_t i = 0; i < loaded.size(); i++)
+	{
+		Chunk& chunk = loaded[i];
+		const uint64_t key = section.Value();
+		const uint64_t isBitmap = section.Value();
+		if (key > 0xFFFF || isBitmap > 1 || (i > 0 && key <= loaded[i - 1].key)) { throw runtime_error("Bitmap section has an invalid chunk"); }
+		chunk.key = static_cast<uint16_t>(key);
+		size_t length;
+		if (isBitmap)
+		{
+			const uint64_t* words = section.Array<uint64_t>(length);
+			if (length != ChunkWords) { throw runtime_error("Bitmap section has an invalid chunk"); }
+			chunk.words.assign(words, words + length);
+			chunk.cardinality = 0;
+			for (size_t w = 0; w < ChunkWords; w++) { chunk.cardinality += BitCount(words[w]); }
+			if (chunk.cardinality <= ArrayLimit) { throw runtime_error("Bitmap section has an invalid chunk"); }
+			size_t last = ChunkWords - 1;
+			while (words[last] == 0) { last--; }
+			highest = static_cast<uint32_t>(last * 64 + 63);
+			while (!((words[last] >> (highest & 63)) & 1)) { highest--; }
+		}
+		else
+		{
+			const uint16_t* lows = section.Array<uint16_t>(length);
+			if (length == 0 || length > ArrayLimit) { throw runtime_error("Bitmap section has an invalid chunk"); }
+			for (size_t l = 1; l < length; l++)
+			{
+				if (lows[l] <= lows[l - 1]) { throw runtime_error("Bitmap section has an invalid chunk"); }
+			}
+			chunk.array.assign(lows, lows + length);
+			chunk.cardinality = static_cast<uint32_t>(length);
+			highest = lows[length - 1];
+		}
+	}
+	if (!loaded.empty() && ((static_cast<uint64_t>(loaded.back().key) << 16) | highest) >= limit)
+	{
+		throw runtime_error("Bitmap section holds an ordinal out of range");
+	}
+	chunks.swap(loaded);
+}
+
+template<Bitmap::WordOp Op>
+uint32_t Bitmap::CombineWords(const uint64_t* a, const uint64_t* b, uint64_t* out)
+{
+#if defined(__AVX2__)
+	for (size_t i = 0; i < ChunkWords; i += 4)
+	{
+		const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		__m256i r;
+		if (Op == WORD_AND) { r = _mm256_and_si256(x, y); }
+		else if (Op == WORD_OR) { r = _mm256_or_si256(x, y); }
+		else { r = _mm256_andnot_si256(y, x); }
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+	}
+#else
+	for (size_t i = 0; i < ChunkWords; i++)
+	{
+		if (Op == WORD_AND) { out[i] = a[i] & b[i]; }
+		else if (Op == WORD_OR) { out[i] = a[i] | b[i]; }
+		else { out[i] = a[i] & ~b[i]; }
+	}
+#endif
+	uint32_t count = 0;
+	for (size_t i = 0; i < ChunkWords; i++) { count += BitCount(out[i]); }
+	return count;
+}
+
+void Bitmap::ToBitmapChunk(Chunk& chunk)
+{
+	chunk.words.assign(ChunkWords, 0);
+	for (vector<uint16_t>::const_iterator low = chunk.array.begin(); low != chunk.array.end(); low++)
+	{
+		chunk.words[*low >> 6] |= uint64_t(1) << (*low & 63);
+	}
+	vector<uint16_t>().swap(chunk.array);
+}
+
+void Bitmap::Compact(Chunk& chunk)
+{
+	if (!chunk.IsBitmap() || chunk.cardinality > ArrayLimit) { return; }
+	chunk.array.reserve(chunk.cardinality);
+	for (size_t i = 0; i < ChunkWords; i++)
+	{
+		for (uint64_t word = chunk.words[i]; word != 0; word &= word - 1)
+		{
+			chunk.array.push_back(static_cast<uint16_t>(i * 64 + LowestBit(word)));
+		}
+	}
+	vector<uint64_t>().swap(chunk.words);
+}
+
+void Bitmap::AndChunk(Chunk& a, const Chunk& b)
+{
+	if (a.IsBitmap() && b.IsBitmap())
+	{
+		a.cardinality = CombineWords<WORD_AND>(a.words.data(), b.words.data(), a.words.data());
+		Compact(a);
+	}
+	else if (a.IsBitmap())
+	{
+		vector<uint16_t> kept;
+		for (vector<uint16_t>::const_iterator low = b.array.begin(); low != b.array.end(); low++)
+		{
+			if (TestBit(a.words, *low)) { kept.push_back(*low); }
+		}
+		a.array.swap(kept);
+		vector<uint64_t>().swap(a.words);
+		a.cardinality = static_cast<uint32_t>(a.array.size());
+	}
+	else if (b.IsBitmap())
+	{
+		a.array.erase(remove_if(a.array.begin(), a.array.end(), [&b](uint16_t low) { return !TestBit(b.words, low); }), a.array.end());
+		a.cardinality = static_cast<uint32_t>(a.array.size());
+	}
+	else
+	{
+		vector<uint16_t> kept;
+		set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), back_inserter(kept));
+		a.array.swap(kept);
+		a.cardinality = static_cast<uint32_t>(a.array.size());
+	}
+}
+
+void Bitmap::OrChunk(Chunk& a, const Chunk& b)
+{
+	if (a.IsBitmap() && b.IsBitmap())
+	{
+		a.cardinality = CombineWords<WORD_OR>(a.words.data(), b.words.data(), a.words.data());
+		return;
+	}
+	if (!a.IsBitmap() && !b.IsBitmap() && a.cardinality + b.cardinality <= ArrayLimit)
+	{
+		vector<uint16_t> merged;
+		merged.reserve(a.array.size() + b.array.size());
+		set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), back_inserter(merged));
+		a.array.swap(merged);
+		a.cardinality = static_cast<uint32_t>(a.array.size());
+		return;
+	}
+	// The union may exceed ArrayLimit: work on a bitmap and set the array's bits in it
+	if (!a.IsBitmap() && b.IsBitmap())
+	{
+		Chunk array = move(a);
+		a = b;
+		a.key = array.key;
+		SetBits(a, array.array);
+	}
+	else
+	{
+		if (!a.IsBitmap()) { ToBitmapChunk(a); }
+		SetBits(a, b.array);
+	}
+}
+
+void Bitmap::AndNotChunk(Chunk& a, const Chunk& b)
+{
+	if (a.IsBitmap() && b.IsBitmap())
+	{
+		a.cardinality = CombineWords<WORD_ANDNOT>(a.words.data(), b.words.data(), a.words.data());
+		Compact(a);
+	}
+	else if (a.IsBitmap())
+	{
+		for (vector<uint16_t>::const_iterator low = b.array.begin(); low != b.array.end(); low++)
+		{
+			uint64_t& word = a.words[*low >> 6];
+			const uint64_t bit = uint64_t(1) << (*low & 63);
+			if (word & bit) { word &= ~bit; a.cardinality--; }
+		}
+		Compact(a);
+	}
+	else if (b.IsBitmap())
+	{
+		a.array.erase(remove_if(a.array.begin(), a.array.end(), [&b](uint16_t low) { return TestBit(b.words, low); }), a.array.end());
+		a.cardinality = static_cast<uint32_t>(a.array.size());
+	}
+	else
+	{
+		vector<uint16_t> kept;
+		set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), back_inserter(kept));
+		a.array.swap(kept);
+		a.cardinality = static_cast<uint32_t>(a.array.size());
+	}
+}
+
+void Bitmap::SetBits(Chunk& chunk, const vector<uint16_t>& lows)
+{
+	for (vector<uint16_t>::const_iterator low = lows.begin(); low != lows.end(); low++)
+	{
+		uint64_t& word = chunk.words[*low >> 6];
+		const uint64_t bit = uint64_t(1) << (*low & 63);
+		if (!(word & bit)) { word |= bit; chunk.cardinality++; }
+	}
+}
+
+Bitmap& Bitmap::operator&=(const Bitmap& other)
+{
+	vector<Chunk> kept;
+	vector<Chunk>::const_iterator y = other.chunks.begin();
+	for (vector<Chunk>::iterator x = chunks.begin(); x != chunks.end(); x++)
+	{
+		while (y != other.chunks.end() && y->key < x->key) { y++; }
+		if (y == other.chunks.end()) { break; }
+		if (y->key != x->key) { continue; }
+		AndChunk(*x, *y);
+		if (x->cardinality > 0) { kept.push_back(move(*x)); }
+	}
+	chunks.swap(kept);
+	return *this;
+}
+
+Bitmap& Bitmap::operator|=(const Bitmap& other)
+{
+	vector<Chunk> merged;
+	merged.reserve(chunks.size() + other.chunks.size());
+	vector<Chunk>::iterator x = chunks.begin();
+	vector<Chunk>::const_iterator y = other.chunks.begin();
+	while (x != chunks.end() || y != other.chunks.end())
+	{
+		if (y == other.chunks.end() || (x != chunks.end() && x->key < y->key)) { merged.push_back(move(*x++)); }
+		else if (x == chunks.end() || y->key < x->key) { merged.push_back(*y++); }
+		else
+		{
+			OrChunk(*x, *y++);
+			merged.push_back(move(*x++));
+		}
+	}
+	chunks.swap(merged);
+	return *this;
+}
+
+Bitmap& Bitmap::operator-=(const Bitmap& other)
+{
+	vector<Chunk> kept;
+	vector<Chunk>::const_iterator y = other.chunks.begin();
+	for (vector<Chunk>::iterator x = chunks.begin(); x != chunks.end(); x++)
+	{
+		while (y != other.chunks.end() && y->key < x->key) { y++; }
+		if (y != other.chunks.end() && y->key == x->key) { AndNotChunk(*x, *y); }
+		if (x->cardinality > 0) { kept.push_back(move(*x)); }
+	}
+	chunks.swap(kept);
+	return *this;
+}
+
+Bitmap And(const Bitmap& a, const Bitmap& b)
+{
+	Bitmap result(a);
+	return result &= b;
+}
+
+Bitmap Or(const Bitmap& a, const Bitmap& b)
+{
+	Bitmap result(a);
+	return result |= b;
+}
+
+Bitmap AndNot(const Bitmap& a, const Bitmap& b)
+{
+	Bitmap result(a);
+	return result -= b;
+}
+
+#endif
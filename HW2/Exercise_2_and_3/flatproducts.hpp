@@ -0,0 +1,226 @@
+/**
+ * flatproducts.hpp defines fixed-size, trivially copyable representations of the Bond, IRSwap and Future products
+ * so that they can be placed in shared memory or files and read in place by another process
+ *
+ * The string fields have fixed widths, which limit the products that can be flattened: bond and future productIds of
+ * at most 15 characters, swap productIds of at most 23 and bond tickers of at most 7. The rich classes accept longer
+ * strings; ToFlat throws length_error for them.
+ */
+
+#ifndef FLATPRODUCTS_HPP
+#define FLATPRODUCTS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "products.hpp"
+
+// Day serial stored for a special (not-a-date) date
+const int32_t NO_DAY_SERIAL = numeric_limits<int32_t>::min();
+
+// Days since 1970-01-01 of a date, or NO_DAY_SERIAL for not_a_date_time and the other special values
+inline int32_t ToDaySerial(const date& _date)
+{
+	if (_date.is_special())
+	{
+		return NO_DAY_SERIAL;
+	}
+	return static_cast<int32_t>((_date - date(1970, Jan, 1)).days());
+}
+
+// Date of a day serial produced by ToDaySerial
+inline date FromDaySerial(int32_t _daySerial)
+{
+	if (_daySerial == NO_DAY_SERIAL)
+	{
+		return date(not_a_date_time);
+	}
+	return date(1970, Jan, 1) + date_duration(_daySerial);
+}
+
+// Copy a string into a fixed-width NUL-padded field, throwing length_error if it does not fit (one byte is kept for the NUL)
+template<size_t N>
+void ToFixedString(const string& _value, char (&_field)[N])
+{
+	if (_value.size() >= N)
+	{
+		throw length_error("'" + _value + "' does not fit in a " + to_string(N - 1) + "-character field");
+	}
+	memset(_field, 0, N);
+	memcpy(_field, _value.data(), _value.size());
+}
+
+// Read a fixed-width NUL-padded field back into a string
+template<size_t N>
+string FromFixedString(const char (&_field)[N])
+{
+	return string(_field, strnlen(_field, N));
+}
+
+/**
+ * Flat Bond: 40 bytes, no pointers.
+ * Enums are packed into single bytes and the maturity date is a day serial, so the record can be copied with memcpy,
+ * compared field by field in place, and shared between processes.
+ */
+struct FlatBond
+{
+	char productId[16]; // CUSIP (9) or ISIN (12), NUL padded
+	char ticker[8]; // NUL padded
+	float coupon;
+	int32_t maturityDate; // days since 1970-01-01
+	uint8_t bondIdType; // BondIdType
+	uint8_t padding[7];
+};
+
+/**
+ * Flat IRSwap: 44 bytes, no pointers.
+ */
+struct FlatIRSwap
+{
+	char productId[24]; // NUL padded
+	int32_t effectiveDate; // days since 1970-01-01
+	int32_t terminationDate; // days since 1970-01-01
+	int32_t termYears;
+	uint8_t fixedLegDayCountConvention; // DayCountConvention
+	uint8_t floatingLegDayCountConvention; // DayCountConvention
+	uint8_t fixedLegPaymentFrequency; // PaymentFrequency
+	uint8_t floatingIndex; // FloatingIndex
+	uint8_t floatingIndexTenor; // FloatingIndexTenor
+	uint8_t currency; // Currency
+	uint8_t swapType; // SwapType
+	uint8_t swapLegType; // SwapLegType
+};
+
+// Which Future class a FlatFuture was made from
+enum FlatFutureKind { PLAIN_FUTURE, EURODOLLAR_FUTURE, BOND_FUTURE };
+
+/**
+ * Flat Future: 32 bytes, no pointers.
+ * Also holds the extra field of the EuroDollarFuture (LIBOR rate) and BondFuture (coupon) subclasses.
+ */
+struct FlatFuture
+{
+	char productId[16]; // NUL padded
+	int32_t maturityDate; // days since 1970-01-01
+	int32_t multiplier;
+	float rate; // EuroDollarFuture LIBOR rate or BondFuture coupon, 0 for a plain Future
+	uint8_t futureType; // FutureType
+	uint8_t futureExchange; // FutureExchange
+	uint8_t kind; // FlatFutureKind
+	uint8_t padding;
+};
+
+static_assert(is_trivially_copyable<FlatBond>::value && is_standard_layout<FlatBond>::value, "FlatBond must be memcpy-able");
+static_assert(is_trivially_copyable<FlatIRSwap>::value && is_standard_layout<FlatIRSwap>::value, "FlatIRSwap must be memcpy-able");
+static_assert(is_trivially_copyable<FlatFuture>::value && is_standard_layout<FlatFuture>::value, "FlatFuture must be memcpy-able");
+static_assert(sizeof(FlatBond) == 40 && sizeof(FlatIRSwap) == 44 && sizeof(FlatFuture) == 32, "Flat layouts are shared between builds");
+
+// Convert a Bond to its flat representation; throws length_error if the productId is longer than 15 characters or
+// the ticker longer than 7
+inline FlatBond ToFlat(const Bond& bond)
+{
+	FlatBond flat = {};
+	ToFixedString(bond.GetProductId(), flat.productId);
+	ToFixedString(bond.GetTicker(), flat.ticker);
+	flat.coupon = bond.GetCoupon();
+	flat.maturityDate = ToDaySerial(bond.GetMaturityDate());
+	flat.bondIdType = static_cast<uint8_t>(bond.GetBondIdType());
+	return flat;
+}
+
+// Rebuild the Bond from its flat representation
+inline Bond FromFlat(const FlatBond& flat)
+{
+	return Bond(FromFixedString(flat.productId), static_cast<BondIdType>(flat.bondIdType), FromFixedString(flat.ticker), flat.coupon, FromDaySerial(flat.maturityDate));
+}
+
+// Convert an IRSwap to its flat representation; throws length_error if the productId is longer than 23 characters
+inline FlatIRSwap ToFlat(const IRSwap& swap)
+{
+	FlatIRSwap flat = {};
+	ToFixedString(swap.GetProductId(), flat.productId);
+	flat.effectiveDate = ToDaySerial(swap.GetEffectiveDate());
+	flat.terminationDate = ToDaySerial(swap.GetTerminationDate());
+	flat.termYears = swap.GetTermYears();
+	flat.fixedLegDayCountConvention = static_cast<uint8_t>(swap.GetFixedLegDayCountConvention());
+	flat.floatingLegDayCountConvention = static_cast<uint8_t>(swap.GetFloatingLegDayCountConvention());
+	flat.fixedLegPaymentFrequency = static_cast<uint8_t>(swap.GetFixedLegPaymentFrequency());
+	flat.floatingIndex = static_cast<uint8_t>(swap.GetFloatingIndex());
+	flat.floatingIndexTenor = static_cast<uint8_t>(swap.GetFloatingIndexTenor());
+	flat.currency = static_cast<uint8_t>(swap.GetCurrency());
+	flat.swapType = static_cast<uint8_t>(swap.GetSwapType());
+	flat.swapLegType = static_cast<uint8_t>(swap.GetSwapLegType());
+	return flat;
+}
+
+// Rebuild the IRSwap from its flat representation
+inline IRSwap FromFlat(const FlatIRSwap& flat)
+{
+	return IRSwap(FromFixedString(flat.productId), static_cast<DayCountConvention>(flat.fixedLegDayCountConvention), static_cast<DayCountConvention>(flat.floatingLegDayCountConvention),
+				  static_cast<PaymentFrequency>(flat.fixedLegPaymentFrequency), static_cast<FloatingIndex>(flat.floatingIndex), static_cast<FloatingIndexTenor>(flat.floatingIndexTenor),
+				  FromDaySerial(flat.effectiveDate), FromDaySerial(flat.terminationDate), static_cast<Currency>(flat.currency), flat.termYears,
+				  static_cast<SwapType>(flat.swapType), static_cast<SwapLegType>(flat.swapLegType));
+}
+
+// Convert a Future to its flat representation; throws length_error if the productId is longer than 15 characters
+inline FlatFuture ToFlat(const Future& future)
+{
+	FlatFuture flat = {};
+	ToFixedString(future.GetProductId(), flat.productId);
+	flat.maturityDate = ToDaySerial(future.GetMaturityDate());
+	flat.multiplier = future.GetMultiplier();
+	flat.futureType = static_cast<uint8_t>(future.GetFutureType());
+	flat.futureExchange = static_cast<uint8_t>(future.GetFutureExchange());
+	flat.kind = PLAIN_FUTURE;
+	return flat;
+}
+
+// Convert a EuroDollarFuture to its flat representation, keeping the LIBOR rate
+inline FlatFuture ToFlat(const EuroDollarFuture& future)
+{
+	FlatFuture flat = ToFlat(static_cast<const Future&>(future));
+	flat.rate = future.GetLiborRate();
+	flat.kind = EURODOLLAR_FUTURE;
+	return flat;
+}
+
+// Convert a BondFuture to its flat representation, keeping the coupon
+inline FlatFuture ToFlat(const BondFuture& future)
+{
+	FlatFuture flat = ToFlat(static_cast<const Future&>(future));
+	flat.rate = future.GetCoupon();
+	flat.kind = BOND_FUTURE;
+	return flat;
+}
+
+// Rebuild the Future part of a flat future (the subclass field is dropped)
+inline Future FromFlat(const FlatFuture& flat)
+{
+	return Future(FromFixedString(flat.productId), static_cast<FutureType>(flat.futureType), static_cast<FutureExchange>(flat.futureExchange), flat.multiplier, FromDaySerial(flat.maturityDate));
+}
+
+// Rebuild a EuroDollarFuture; throws invalid_argument if the flat future was not made from one
+inline EuroDollarFuture ToEuroDollarFuture(const FlatFuture& flat)
+{
+	if (flat.kind != EURODOLLAR_FUTURE)
+	{
+		throw invalid_argument("Not a EuroDollarFuture: " + FromFixedString(flat.productId));
+	}
+	return EuroDollarFuture(FromFixedString(flat.productId), static_cast<FutureExchange>(flat.futureExchange), flat.multiplier, FromDaySerial(flat.maturityDate), flat.rate);
+}
+
+// Rebuild a BondFuture; throws invalid_argument if the flat future was not made from one
+inline BondFuture ToBondFuture(const FlatFuture& flat)
+{
+	if (flat.kind != BOND_FUTURE)
+	{
+		throw invalid_argument("Not a BondFuture: " + FromFixedString(flat.productId));
+	}
+	return BondFuture(FromFixedString(flat.productId), static_cast<FutureExchange>(flat.futureExchange), flat.multiplier, FromDaySerial(flat.maturityDate), flat.rate);
+}
+
+#endif
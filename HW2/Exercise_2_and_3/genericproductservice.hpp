@@ -0,0 +1,664 @@
+/**
+ * genericproductservice.hpp defines ProductService, the storage, secondary indexes and query engine shared by every
+ * product type, with its indexes declared at compile time
+ */
+
+#ifndef GENERICPRODUCTSERVICE_HPP
+#define GENERICPRODUCTSERVICE_HPP
+
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "bitmap.hpp"
+#include "indexsection.hpp"
+#include "productindex.hpp"
+#include "productview.hpp"
+#include "soa.hpp"
+
+using namespace std;
+
+/**
+ * Hash of product identifiers that also accepts string_view, so that lookups can be made without building a string.
+ */
+struct ProductIdHash
+{
+	typedef void is_transparent;
+
+	size_t operator()(string_view _productId) const { return hash<string_view>()(_productId); }
+};
+
+// Primary store of a ProductService: products by productId. Nodes never move, even on rehash, so indexes can point into it.
+template<typename V>
+using ProductMap = unordered_map<string, V, ProductIdHash, equal_to<> >;
+
+// Find a product by productId without inserting anything; nullptr if there is none. Standard libraries with
+// heterogeneous unordered lookup (C++20) search by the string_view itself; otherwise the id is copied into a string,
+// which does not allocate for ids short enough for the small string buffer (CUSIPs, ISINs).
+template<typename V>
+V* FindProduct(ProductMap<V>& _products, string_view _productId)
+{
+#if defined(__cpp_lib_generic_unordered_lookup)
+	typename ProductMap<V>::iterator it = _products.find(_productId);
+#else
+	typename ProductMap<V>::iterator it = _products.find(string(_productId));
+#endif
+	return it == _products.end() ? nullptr : &(it->second);
+}
+
+template<typename V>
+const V* FindProduct(const ProductMap<V>& _products, string_view _productId)
+{
+	return FindProduct(const_cast<ProductMap<V>&>(_products), _productId);
+}
+
+// Copy the products of a view into a result vector
+template<typename V>
+vector<V> ToVector(const ProductView<V>& products)
+{
+	return vector<V>(products.begin(), products.end());
+}
+
+// Copy the products of bucketed views into result vectors
+template<typename V>
+vector<vector<V> > ToVectors(const vector<ProductView<V> >& buckets)
+{
+	vector<vector<V> > return_vecs;
+	for (typename vector<ProductView<V> >::const_iterator it = buckets.begin(); it != buckets.end(); it++)
+	{
+		return_vecs.push_back(ToVector(*it));
+	}
+	return return_vecs;
+}
+
+/**
+ * Attribute type of a const getter of a product, e.g. Currency for &IRSwap::GetCurrency.
+ */
+template<typename G>
+struct GetterTraits;
+
+template<typename R, typename C>
+struct GetterTraits<R (C::*)() const>
+{
+	typedef typename decay<R>::type Key;
+};
+
+// Attribute type of the product getter
+template<auto Getter>
+using IndexKey = typename GetterTraits<decltype(Getter)>::Key;
+
+/**
+ * Declares an equality index on the attribute returned by the product getter, e.g. IndexOn<&IRSwap::GetCurrency>:
+ * a posting list and a bitmap of ordinals per attribute value.
+ */
+template<auto Getter>
+struct IndexOn
+{
+};
+
+/**
+ * Declares a sorted range index on the attribute returned by the product getter, e.g. RangeOn<&Bond::GetMaturityDate>.
+ */
+template<auto Getter>
+struct RangeOn
+{
+};
+
+/**
+ * Declares a store kept row for row with the ordinals, e.g. StoreIn<IRSwapColumns>: S has Add(const T&), called once per
+ * inserted product so that row i holds the product of ordinal i, Reserve(size_t), and Save(SectionWriter&) and
+ * Load(SectionReader&, size_t rows) to be saved and restored with the service.
+ */
+template<typename S>
+struct StoreIn
+{
+};
+
+// Tag at the start of a saved index, so that a section is not read back as an index of another kind
+enum IndexSectionKind { EQUALITY_SECTION = 1, RANGE_SECTION = 2, STORE_SECTION = 3 };
+
+/**
+ * Storage of a declared index, maintained by ProductService on every insert.
+ * Each storage can also be saved to a section and loaded back for the same products, with their ordinals, without
+ * being rebuilt product by product.
+ * Uses product type T and the index declaration (IndexOn, RangeOn or StoreIn).
+ */
+template<typename T, typename Index>
+class IndexStorage;
+
+template<typename T, auto Getter>
+class IndexStorage<T, IndexOn<Getter> >
+{
+public:
+	typedef IndexKey<Getter> Key;
+
+	// String attributes (tickers) take many values and are looked up by hash; enums and numbers take a few, kept in order
+	typedef typename conditional<is_same<Key, string>::value, unordered_map<Key, vector<const T*> >, map<Key, vector<const T*> > >::type PostingMap;
+
+	// Index a stored product with its ordinal
+	void Add(const T* product, uint32_t ordinal);
+
+	// Make room for the given number of products; posting lists grow per value, so there is nothing to reserve
+	void Reserve(size_t) {}
+
+	// Nothing is deferred to the first query
+	void Finalize() {}
+
+	// Write the bitmap of every attribute value; the posting lists hold the same ordinals in the same order
+	void Save(SectionWriter& section) const;
+
+	// Load the bitmaps written by Save and rebuild the posting lists from them; ordinals gives the product of each ordinal
+	void Load(SectionReader& section, const vector<const T*>& ordinals);
+
+	PostingIndex<Key, T, PostingMap> postings; // products by attribute value, in the order they were added
+	BitmapIndex<Key> bitmaps; // product ordinals by attribute value
+
+};
+
+template<typename T, auto Getter>
+void IndexStorage<T, IndexOn<Getter> >::Add(const T* product, uint32_t ordinal)
+{
+	const Key key = (product->*Getter)();
+	postings.Add(key, product);
+	bitmaps.Add(key, ordinal);
+}
+
+template<typename T, auto Getter>
+void IndexStorage<T, IndexOn<Getter> >::Save(SectionWriter& section) const
+{
+	section.Value(EQUALITY_SECTION);
+	section.Value(bitmaps.KeyCount());
+	bitmaps.ForEach([&section](const Key& key, const Bitmap& bitmap)
+	{
+		SectionKey<Key>::Save(section, key);
+		bitmap.Save(section);
+	});
+}
+
+template<typename T, auto Getter>
+void IndexStorage<T, IndexOn<Getter> >::Load(SectionReader& section, const vector<const T*>& ordinals)
+{
+	if (section.Value() != EQUALITY_SECTION) { throw runtime_error("Index section is not an equality index"); }
+	const uint64_t keyCount = section.Value();
+	size_t indexed = 0;
+	for (uint64_t i = 0; i < keyCount; i++)
+	{
+		const Key key = SectionKey<Key>::Load(section);
+		Bitmap bitmap;
+		bitmap.Load(section, ordinals.size());
+		if (bitmap.Empty() || postings.Count(key) != 0) { throw runtime_error("Index section has an empty or repeated key"); }
+		vector<const T*> products;
+		products.reserve(bitmap.Cardinality());
+		bitmap.ForEach([&products, &ordinals](uint32_t ordinal) { products.push_back(ordinals[ordinal]); });
+		indexed += products.size();
+		postings.Assign(key, move(products));
+		bitmaps.Assign(key, move(bitmap));
+	}
+	if (indexed != ordinals.size()) { throw runtime_error("Index section does not index every product once"); }
+}
+
+template<typename T, auto Getter>
+class IndexStorage<T, RangeOn<Getter> >
+{
+public:
+	typedef IndexKey<Getter> Key;
+
+	// Index a stored product with its ordinal
+	void Add(const T* product, uint32_t ordinal);
+
+	// Make room for the given number of products
+	void Reserve(size_t count) { range.Reserve(count); }
+
+	// Sort the range index now instead of on its first query
+	void Finalize() { range.Finalize(); }
+
+	// Write the ordinals of the products in attribute order
+	void Save(SectionWriter& section) const;
+
+	// Load the order written by Save, so that the index is not sorted again; ordinals gives the product of each ordinal
+	void Load(SectionReader& section, const vector<const T*>& ordinals);
+
+	RangeIndex<Key, T> range; // products ordered by attribute value
+
+};
+
+template<typename T, auto Getter>
+void IndexStorage<T, RangeOn<Getter> >::Add(const T* product, uint32_t ordinal)
+{
+	range.Add((product->*Getter)(), product, ordinal);
+}
+
+template<typename T, auto Getter>
+void IndexStorage<T, RangeOn<Getter> >::Save(SectionWriter& section) const
+{
+	section.Value(RANGE_SECTION);
+	const vector<uint32_t>& order = range.Ordinals();
+	section.Array(order.data(), order.size());
+}
+
+template<typename T, auto Getter>
+void IndexStorage<T, RangeOn<Getter> >::Load(SectionReader& section, const vector<const T*>& ordinals)
+{
+	if (section.Value() != RANGE_SECTION) { throw runtime_error("Index section is not a range index"); }
+	size_t count;
+	const uint32_t* order = section.Array<uint32_t>(count);
+	if (count != ordinals.size()) { throw runtime_error("Index section does not hold every product"); }
+	// Keys are read from the products in ordinal order, the order they sit in memory, and only then permuted
+	vector<Key> keysByOrdinal;
+	keysByOrdinal.reserve(count);
+	for (size_t ordinal = 0; ordinal < count; ordinal++) { keysByOrdinal.push_back((ordinals[ordinal]->*Getter)()); }
+	vector<bool> seen(count, false);
+	vector<Key> keys;
+	vector<const T*> products;
+	keys.reserve(count);
+	products.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		if (order[i] >= count || seen[order[i]]) { throw runtime_error("Index section has an invalid or repeated ordinal"); }
+		seen[order[i]] = true;
+		keys.push_back(keysByOrdinal[order[i]]);
+		products.push_back(ordinals[order[i]]);
+	}
+	range.Assign(move(keys), move(products), vector<uint32_t>(order, order + count));
+}
+
+template<typename T, typename S>
+class IndexStorage<T, StoreIn<S> >
+{
+public:
+	// Append the row of a stored product; its ordinal is the row
+	void Add(const T* product, uint32_t) { store.Add(*product); }
+
+	// Make room for the given number of rows
+	void Reserve(size_t count) { store.Reserve(count); }
+
+	// Nothing is deferred to the first query
+	void Finalize() {}
+
+	// Write the store
+	void Save(SectionWriter& section) const { section.Value(STORE_SECTION); store.Save(section); }
+
+	// Load the store written by Save, which must hold one row per product
+	void Load(SectionReader& section, const vector<const T*>& ordinals);
+
+	S store; // one row per product, in ordinal order
+
+};
+
+template<typename T, typename S>
+void IndexStorage<T, StoreIn<S> >::Load(SectionReader& section, const vector<const T*>& ordinals)
+{
+	if (section.Value() != STORE_SECTION) { throw runtime_error("Index section is not a store"); }
+	store.Load(section, ordinals.size());
+}
+
+template<typename S>
+class ServiceQuery;
+
+/**
+ * Product Service to own reference data over a set of products of one type, with secondary indexes declared at compile
+ * time, e.g. ProductService<IRSwap, IndexOn<&IRSwap::GetCurrency>, RangeOn<&IRSwap::GetTerminationDate> >.
+ * Key is the productId string, value is a T, held in a hash map; each product also gets an ordinal, its position in the
+ * order products were added, which the bitmap indexes and queries refer to.
+ * Every index is updated on Insert. Equality queries (View, Get) cost O(result size) and return products in the order
+ * they were added; range queries cost O(log n + result size) and return products in attribute order; multi-predicate
+ * queries (Query) cost one bitmap operation per predicate. Views are invalidated by the next Insert.
+ * Range indexes sort lazily on their first query after an out-of-order Insert, which mutates them inside const
+ * queries: call Finalize after inserting and before querying from several threads (the bulk loaders do).
+ * SaveIndexes and Restore save the indexes and load them back with the products, e.g. in a snapshot, so that a
+ * restore does not rebuild them product by product.
+ * Uses product type T, which has a GetProductId method, and the index declarations Indexes.
+ */
+template<typename T, typename... Indexes>
+class ProductService : public Service<string, T>
+{
+public:
+	typedef T ProductType;
+
+	// Number of declared indexes, and so of sections written by SaveIndexes
+	static const size_t IndexCount = sizeof...(Indexes);
+
+	// ctor; the description names the products in error messages, e.g. "bond"
+	explicit ProductService(const string& _description = "product");
+
+	// Return the product data for a particular product identifier; throws out_of_range if there is no such product
+	T& GetData(string productId) override;
+
+	// Return the product with the product identifier, or nullptr if there is none
+	const T* Find(string_view productId) const;
+
+	// Return whether there is a product with the product identifier
+	bool Contains(string_view productId) const;
+
+	// Add a product to the service and to every index; returns the stored product, or nullptr if the productId is
+	// already known, in which case the first definition is kept and stays indexed
+	const T* Insert(const T& product);
+
+	// Add a product, moving it into the service instead of copying it; it is left untouched if the productId is already known
+	const T* Insert(T&& product);
+
+	// Make room for the given total number of products, so that a bulk load does not rehash or reallocate
+	void Reserve(size_t count);
+
+	// Complete the work the indexes defer to their first query (sorting the range indexes), so that const queries
+	// do not modify the service until the next Insert and can run concurrently
+	void Finalize();
+
+	// Write every declared index to its own section, in declaration order
+	vector<SectionWriter> SaveIndexes() const;
+
+	// Fill an empty service with count products, product(ordinal) returning each one in ordinal order, and load the
+	// indexes written by SaveIndexes for those products from sections instead of rebuilding them; throws
+	// runtime_error, leaving the service empty, if it was not empty, a productId repeats or a section does not match
+	// the declared indexes
+	template<typename F>
+	void Restore(size_t count, F product, vector<SectionReader>& sections);
+
+	// Return the number of products
+	size_t Size() const;
+
+	// Return the products in the order they were added; a product's position is its ordinal
+	const vector<const T*>& Ordinals() const;
+
+	// Return the ordinals of every product
+	const Bitmap& All() const;
+
+	// Return the posting lists and the bitmaps of an IndexOn index
+	template<auto Getter>
+	const PostingIndex<IndexKey<Getter>, T, typename IndexStorage<T, IndexOn<Getter> >::PostingMap>& Postings() const;
+	template<auto Getter>
+	const BitmapIndex<IndexKey<Getter> >& Bitmaps() const;
+
+	// Return the sorted products of a RangeOn index
+	template<auto Getter>
+	const RangeIndex<IndexKey<Getter>, T>& Range() const;
+
+	// Return the store of a StoreIn declaration
+	template<typename S>
+	const S& Store() const;
+
+	// View the products with the specified attribute value of an IndexOn index, without copying them
+	template<auto Getter>
+	ProductView<T> View(const IndexKey<Getter>& _key) const;
+
+	// Get copies of the products with the specified attribute value of an IndexOn index
+	template<auto Getter>
+	vector<T> Get(const IndexKey<Getter>& _key) const;
+
+	// Start a multi-predicate query over all products, e.g. Query().Where<&IRSwap::GetCurrency>(USD).Results()
+	ServiceQuery<ProductService<T, Indexes...> > Query() const;
+
+private:
+	string description; // name of the products in error messages
+	ProductMap<T> products; // cache of products
+	vector<const T*> productsByOrdinal; // products in the order they were added
+	Bitmap all; // ordinals of every product
+	tuple<IndexStorage<T, Indexes>...> indexes; // one storage per declared index
+
+	// Give a product just placed in the map its ordinal and add it to every index; nullptr if the map already held its productId
+	const T* Index(pair<typename ProductMap<T>::iterator, bool> inserted);
+
+};
+
+template<typename T, typename... Indexes>
+ProductService<T, Indexes...>::ProductService(const string& _description) :
+	description(_description)
+{
+}
+
+template<typename T, typename... Indexes>
+T& ProductService<T, Indexes...>::GetData(string productId)
+{
+	T* product = FindProduct(products, productId);
+	if (product == nullptr) { throw out_of_range("Unknown " + description + " " + productId); }
+	return *product;
+}
+
+template<typename T, typename... Indexes>
+const T* ProductService<T, Indexes...>::Find(string_view productId) const
+{
+	return FindProduct(products, productId);
+}
+
+template<typename T, typename... Indexes>
+bool ProductService<T, Indexes...>::Contains(string_view productId) const
+{
+	return Find(productId) != nullptr;
+}
+
+template<typename T, typename... Indexes>
+const T* ProductService<T, Indexes...>::Insert(const T& product)
+{
+	return Index(products.try_emplace(product.GetProductId(), product));
+}
+
+template<typename T, typename... Indexes>
+const T* ProductService<T, Indexes...>::Insert(T&& product)
+{
+	// try_emplace only moves from the product once it knows the productId is new
+	return Index(products.try_emplace(product.GetProductId(), move(product)));
+}
+
+template<typename T, typename... Indexes>
+const T* ProductService<T, Indexes...>::Index(pair<typename ProductMap<T>::iterator, bool> inserted)
+{
+	if (!inserted.second) { return nullptr; }
+
+	const T* stored = &(inserted.first->second);
+	const uint32_t ordinal = static_cast<uint32_t>(productsByOrdinal.size());
+	productsByOrdinal.push_back(stored);
+	all.Add(ordinal);
+	apply([stored, ordinal](IndexStorage<T, Indexes>&... storage) { (storage.Add(stored, ordinal), ...); }, indexes);
+	return stored;
+}
+
+template<typename T, typename... Indexes>
+void ProductService<T, Indexes...>::Reserve(size_t count)
+{
+	products.reserve(count);
+	productsByOrdinal.reserve(count);
+	apply([count](IndexStorage<T, Indexes>&... storage) { (storage.Reserve(count), ...); }, indexes);
+}
+
+template<typename T, typename... Indexes>
+void ProductService<T, Indexes...>::Finalize()
+{
+	apply([](IndexStorage<T, Indexes>&... storage) { (storage.Finalize(), ...); }, indexes);
+}
+
+template<typename T, typename... Indexes>
+vector<SectionWriter> ProductService<T, Indexes...>::SaveIndexes() const
+{
+	vector<SectionWriter> sections(IndexCount);
+	size_t section = 0;
+	apply([&sections, &section](const IndexStorage<T, Indexes>&... storage) { (storage.Save(sections[section++]), ...); }, indexes);
+	return sections;
+}
+
+template<typename T, typename... Indexes>
+template<typename F>
+void ProductService<T, Indexes...>::Restore(size_t count, F product, vector<SectionReader>& sections)
+{
+	if (!productsByOrdinal.empty()) { throw runtime_error("Cannot restore into a " + description + " service that is not empty"); }
+	if (sections.size() != IndexCount) { throw runtime_error("Expected " + to_string(IndexCount) + " " + description + " index sections, found " + to_string(sections.size())); }
+	try
+	{
+		products.reserve(count);
+		productsByOrdinal.reserve(count);
+		for (size_t ordinal = 0; ordinal < count; ordinal++)
+		{
+			T restored = product(ordinal);
+			const string productId = restored.GetProductId();
+			pair<typename ProductMap<T>::iterator, bool> inserted = products.try_emplace(productId, move(restored));
+			if (!inserted.second) { throw runtime_error("Repeated " + description + " " + productId); }
+			productsByOrdinal.push_back(&(inserted.first->second));
+			all.Add(static_cast<uint32_t>(ordinal));
+		}
+		size_t section = 0;
+		apply([this, &sections, &section](IndexStorage<T, Indexes>&... storage) { (storage.Load(sections[section++], productsByOrdinal), ...); }, indexes);
+		for (size_t i = 0; i < sections.size(); i++) { sections[i].Finish(); }
+	}
+	catch (...)
+	{
+		products.clear();
+		productsByOrdinal.clear();
+		all = Bitmap();
+		indexes = tuple<IndexStorage<T, Indexes>...>();
+		throw;
+	}
+}
+
+template<typename T, typename... Indexes>
+size_t ProductService<T, Indexes...>::Size() const
+{
+	return productsByOrdinal.size();
+}
+
+template<typename T, typename... Indexes>
+const vector<const T*>& ProductService<T, Indexes...>::Ordinals() const
+{
+	return productsByOrdinal;
+}
+
+template<typename T, typename... Indexes>
+const Bitmap& ProductService<T, Indexes...>::All() const
+{
+	return all;
+}
+
+template<typename T, typename... Indexes>
+template<auto Getter>
+const PostingIndex<IndexKey<Getter>, T, typename IndexStorage<T, IndexOn<Getter> >::PostingMap>& ProductService<T, Indexes...>::Postings() const
+{
+	return get<IndexStorage<T, IndexOn<Getter> > >(indexes).postings;
+}
+
+template<typename T, typename... Indexes>
+template<auto Getter>
+const BitmapIndex<IndexKey<Getter> >& ProductService<T, Indexes...>::Bitmaps() const
+{
+	return get<IndexStorage<T, IndexOn<Getter> > >(indexes).bitmaps;
+}
+
+template<typename T, typename... Indexes>
+template<auto Getter>
+const RangeIndex<IndexKey<Getter>, T>& ProductService<T, Indexes...>::Range() const
+{
+	return get<IndexStorage<T, RangeOn<Getter> > >(indexes).range;
+}
+
+template<typename T, typename... Indexes>
+template<typename S>
+const S& ProductService<T, Indexes...>::Store() const
+{
+	return get<IndexStorage<T, StoreIn<S> > >(indexes).store;
+}
+
+template<typename T, typename... Indexes>
+template<auto Getter>
+ProductView<T> ProductService<T, Indexes...>::View(const IndexKey<Getter>& _key) const
+{
+	return Postings<Getter>().View(_key);
+}
+
+template<typename T, typename... Indexes>
+template<auto Getter>
+vector<T> ProductService<T, Indexes...>::Get(const IndexKey<Getter>& _key) const
+{
+	return ToVector(View<Getter>(_key));
+}
+
+/**
+ * Base of the fluent queries over a ProductService: predicates on any IndexOn index of the service, by getter.
+ * A query holds pointers into the service, so it must not outlive it or be used across later Inserts.
+ * Uses the service type S and the derived query type Q, which predicates return for chaining.
+ */
+template<typename S, typename Q>
+class IndexedQuery : public ProductQuery<typename S::ProductType, Q>
+{
+public:
+	// Keep the products with the specified attribute value
+	template<auto Getter>
+	Q& Where(const IndexKey<Getter>& _key);
+
+	// Keep the products with an attribute value greater than the specified one
+	template<auto Getter>
+	Q& WhereAbove(const IndexKey<Getter>& _key);
+
+	// Keep the products with an attribute value less than the specified one
+	template<auto Getter>
+	Q& WhereBelow(const IndexKey<Getter>& _key);
+
+protected:
+	// ctor over all products of the service
+	explicit IndexedQuery(const S& _service);
+
+	const S* service;
+
+};
+
+template<typename S, typename Q>
+IndexedQuery<S, Q>::IndexedQuery(const S& _service) :
+	ProductQuery<typename S::ProductType, Q>(_service.Ordinals(), _service.All()), service(&_service)
+{
+}
+
+template<typename S, typename Q>
+template<auto Getter>
+Q& IndexedQuery<S, Q>::Where(const IndexKey<Getter>& _key)
+{
+	return this->Combine(service->template Bitmaps<Getter>().Get(_key));
+}
+
+// Range predicates union whichever side of the split has fewer bitmaps, negating it when that is the complement
+template<typename S, typename Q>
+template<auto Getter>
+Q& IndexedQuery<S, Q>::WhereAbove(const IndexKey<Getter>& _key)
+{
+	const BitmapIndex<IndexKey<Getter> >& bitmaps = service->template Bitmaps<Getter>();
+	if (2 * bitmaps.KeysAbove(_key) <= bitmaps.KeyCount()) { return this->Combine(bitmaps.Above(_key)); }
+	return this->Not().Combine(bitmaps.AtMost(_key));
+}
+
+template<typename S, typename Q>
+template<auto Getter>
+Q& IndexedQuery<S, Q>::WhereBelow(const IndexKey<Getter>& _key)
+{
+	const BitmapIndex<IndexKey<Getter> >& bitmaps = service->template Bitmaps<Getter>();
+	if (2 * bitmaps.KeysBelow(_key) <= bitmaps.KeyCount()) { return this->Combine(bitmaps.Below(_key)); }
+	return this->Not().Combine(bitmaps.AtLeast(_key));
+}
+
+/**
+ * Fluent multi-predicate query over the products of a ProductService, with predicates by getter, e.g.
+ *   service.Query().Where<&Future::GetFutureType>(RATE).Not().Where<&Future::GetFutureExchange>(CME).Results()
+ * Uses the service type S.
+ */
+template<typename S>
+class ServiceQuery : public IndexedQuery<S, ServiceQuery<S> >
+{
+public:
+	// ctor over all products of the service
+	explicit ServiceQuery(const S& _service);
+
+};
+
+template<typename S>
+ServiceQuery<S>::ServiceQuery(const S& _service) :
+	IndexedQuery<S, ServiceQuery<S> >(_service)
+{
+}
+
+template<typename T, typename... Indexes>
+ServiceQuery<ProductService<T, Indexes...> > ProductService<T, Indexes...>::Query() const
+{
+	return ServiceQuery<ProductService<T, Indexes...> >(*this);
+}
+
+#endif
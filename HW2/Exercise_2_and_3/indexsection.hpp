@@ -0,0 +1,153 @@
+/**
+ * indexsection.hpp defines SectionWriter and SectionReader, which save the secondary indexes of a ProductService as
+ * flat arrays and read them back in place, so that a snapshot can restore the indexes without rebuilding them
+ */
+
+#ifndef INDEXSECTION_HPP
+#define INDEXSECTION_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Bytes of a saved index: a sequence of 64-bit values and of arrays of trivially copyable elements. Each array is
+ * preceded by its length and padded to 8 bytes, so every value and array stays 8-byte aligned when the section is
+ * mapped at an 8-byte aligned address.
+ */
+class SectionWriter
+{
+public:
+	// Append a value
+	void Value(uint64_t _value);
+
+	// Append an array of _count elements
+	template<typename P>
+	void Array(const P* _data, size_t _count);
+
+	// Return the bytes written so far, a multiple of 8
+	const vector<char>& Bytes() const;
+
+private:
+	vector<char> bytes;
+
+};
+
+inline void SectionWriter::Value(uint64_t _value)
+{
+	const char* data = reinterpret_cast<const char*>(&_value);
+	bytes.insert(bytes.end(), data, data + sizeof(_value));
+}
+
+template<typename P>
+void SectionWriter::Array(const P* _data, size_t _count)
+{
+	static_assert(is_trivially_copyable<P>::value && alignof(P) <= 8, "Sections hold flat arrays");
+	Value(_count);
+	const char* data = reinterpret_cast<const char*>(_data);
+	bytes.insert(bytes.end(), data, data + _count * sizeof(P));
+	bytes.resize((bytes.size() + 7) & ~size_t(7), 0);
+}
+
+inline const vector<char>& SectionWriter::Bytes() const
+{
+	return bytes;
+}
+
+/**
+ * Reads a section written by SectionWriter, in the order it was written, from memory such as a mapped snapshot, which
+ * must stay valid while the arrays are used. Every read is checked against the end of the section, so a section that
+ * ends early or holds another layout throws runtime_error instead of being read past its end.
+ */
+class SectionReader
+{
+public:
+	// Read the section in the given bytes, which must start at an 8-byte aligned address
+	explicit SectionReader(string_view _bytes);
+
+	// Read the next value
+	uint64_t Value();
+
+	// Return the next array in place, setting _count to its number of elements
+	template<typename P>
+	const P* Array(size_t& _count);
+
+	// Throw runtime_error unless the whole section has been read
+	void Finish() const;
+
+private:
+	string_view bytes;
+	size_t position; // bytes read so far
+
+};
+
+inline SectionReader::SectionReader(string_view _bytes) :
+	bytes(_bytes), position(0)
+{
+	if (reinterpret_cast<uintptr_t>(bytes.data()) % 8 != 0) { throw runtime_error("Index section is not 8-byte aligned"); }
+}
+
+inline uint64_t SectionReader::Value()
+{
+	if (bytes.size() - position < sizeof(uint64_t)) { throw runtime_error("Index section ends early"); }
+	uint64_t value;
+	memcpy(&value, bytes.data() + position, sizeof(value));
+	position += sizeof(value);
+	return value;
+}
+
+template<typename P>
+const P* SectionReader::Array(size_t& _count)
+{
+	static_assert(is_trivially_copyable<P>::value && alignof(P) <= 8, "Sections hold flat arrays");
+	const uint64_t count = Value();
+	if (count > (bytes.size() - position) / sizeof(P)) { throw runtime_error("Index section ends early"); }
+	const size_t size = static_cast<size_t>(count) * sizeof(P);
+	const size_t padded = (size + 7) & ~size_t(7);
+	if (padded > bytes.size() - position) { throw runtime_error("Index section ends early"); }
+	const P* data = reinterpret_cast<const P*>(bytes.data() + position);
+	position += padded;
+	_count = static_cast<size_t>(count);
+	return data;
+}
+
+inline void SectionReader::Finish() const
+{
+	if (position != bytes.size()) { throw runtime_error("Index section has " + to_string(bytes.size() - position) + " unread bytes"); }
+}
+
+/**
+ * How an index key is written to a section. Enums and integers are written as one value and strings as an array of
+ * characters; indexes on other key types cannot be saved until SectionKey is specialized for them.
+ */
+template<typename K, typename Enable = void>
+struct SectionKey;
+
+template<typename K>
+struct SectionKey<K, typename enable_if<is_integral<K>::value || is_enum<K>::value>::type>
+{
+	static void Save(SectionWriter& _section, const K& _key) { _section.Value(static_cast<uint64_t>(static_cast<int64_t>(_key))); }
+
+	static K Load(SectionReader& _section) { return static_cast<K>(static_cast<int64_t>(_section.Value())); }
+};
+
+template<>
+struct SectionKey<string>
+{
+	static void Save(SectionWriter& _section, const string& _key) { _section.Array(_key.data(), _key.size()); }
+
+	static string Load(SectionReader& _section)
+	{
+		size_t length;
+		const char* data = _section.Array<char>(length);
+		return string(data, length);
+	}
+};
+
+#endif
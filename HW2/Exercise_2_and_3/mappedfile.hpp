@@ -0,0 +1,114 @@
+/**
+ * mappedfile.hpp defines MappedFile, a read-only view of a whole file, memory-mapped where the platform supports it
+ */
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPEDFILE_MMAP
+#endif
+
+using namespace std;
+
+/**
+ * Read-only contents of a file.
+ * On POSIX systems the file is mapped with mmap, so opening it costs no copy and pages are read on first touch; elsewhere
+ * it is read into a buffer. The contents stay valid for the lifetime of the MappedFile.
+ */
+class MappedFile
+{
+public:
+	// Open and map the file; throws runtime_error if it cannot be read
+	explicit MappedFile(const string& _path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Return the contents of the file
+	string_view Contents() const;
+
+	// Return the size of the file in bytes
+	size_t Size() const;
+
+private:
+	const char* data; // first byte of the contents
+	size_t size; // number of bytes
+#if !defined(MAPPEDFILE_MMAP)
+	vector<char> buffer; // contents read with stdio where mmap is not available
+#endif
+
+};
+
+inline MappedFile::MappedFile(const string& _path) :
+	data(nullptr), size(0)
+{
+#if defined(MAPPEDFILE_MMAP)
+	const int descriptor = open(_path.c_str(), O_RDONLY);
+	if (descriptor < 0) { throw runtime_error("Cannot open " + _path + ": " + strerror(errno)); }
+	struct stat status;
+	if (fstat(descriptor, &status) != 0)
+	{
+		const int error = errno;
+		close(descriptor);
+		throw runtime_error("Cannot stat " + _path + ": " + strerror(error));
+	}
+	size = static_cast<size_t>(status.st_size);
+	if (size > 0)
+	{
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (mapping == MAP_FAILED)
+		{
+			const int error = errno;
+			close(descriptor);
+			throw runtime_error("Cannot map " + _path + ": " + strerror(error));
+		}
+		madvise(mapping, size, MADV_SEQUENTIAL);
+		data = static_cast<const char*>(mapping);
+	}
+	close(descriptor); // the mapping keeps the file open
+#else
+	FILE* file = fopen(_path.c_str(), "rb");
+	if (file == nullptr) { throw runtime_error("Cannot open " + _path + ": " + strerror(errno)); }
+	char block[65536];
+	size_t read;
+	while ((read = fread(block, 1, sizeof(block), file)) > 0) { buffer.insert(buffer.end(), block, block + read); }
+	const bool failed = ferror(file) != 0;
+	fclose(file);
+	if (failed) { throw runtime_error("Cannot read " + _path); }
+	data = buffer.data();
+	size = buffer.size();
+#endif
+}
+
+inline MappedFile::~MappedFile()
+{
+#if defined(MAPPEDFILE_MMAP)
+	if (data != nullptr) { munmap(const_cast<char*>(data), size); }
+#endif
+}
+
+inline string_view MappedFile::Contents() const
+{
+	return string_view(data, size);
+}
+
+inline size_t MappedFile::Size() const
+{
+	return size;
+}
+
+#endif
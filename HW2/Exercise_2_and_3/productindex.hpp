@@ -0,0 +1,551 @@
+/**
+ * productindex.hpp defines secondary indexes used by the ProductServices to answer attribute queries
+ * without scanning every product
+ */
+
+#ifndef PRODUCTINDEX_HPP
+#define PRODUCTINDEX_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+#include "bitmap.hpp"
+#include "productview.hpp"
+
+using namespace std;
+
+/**
+ * Secondary index from an attribute value to the posting list of products having that value.
+ * Postings are pointers to products owned by the service (which must keep them at a stable address) and are kept in
+ * the order the products were added, so a query costs O(result size) instead of O(universe).
+ * Uses key generic type K, product type V and the map type from K to posting list.
+ */
+template<typename K, typename V, typename Map = map<K, vector<const V*> > >
+class PostingIndex
+{
+public:
+	// Add a product to the posting list of the given key
+	void Add(const K& key, const V* product);
+
+	// Return the posting list of the given key (an empty list if no product has that key)
+	const vector<const V*>& Get(const K& key) const;
+
+	// Return the products of the given key as a view of its posting list
+	ProductView<V> View(const K& key) const;
+
+	// Return the number of products with the given key
+	size_t Count(const K& key) const;
+
+	// Call f(key, postings) for every key that has products
+	template<typename F>
+	void ForEach(F f) const;
+
+	// Return the number of keys that have products
+	size_t KeyCount() const;
+
+	// Replace the posting list of the given key, e.g. with one restored from a snapshot
+	void Assign(const K& key, vector<const V*> products);
+
+	// Remove every posting
+	void Clear();
+
+private:
+	Map postings; // posting list per key
+
+};
+
+template<typename K, typename V, typename Map>
+void PostingIndex<K, V, Map>::Add(const K& key, const V* product)
+{
+	postings[key].push_back(product);
+}
+
+template<typename K, typename V, typename Map>
+const vector<const V*>& PostingIndex<K, V, Map>::Get(const K& key) const
+{
+	static const vector<const V*> empty;
+	typename Map::const_iterator it = postings.find(key);
+	return it == postings.end() ? empty : it->second;
+}
+
+template<typename K, typename V, typename Map>
+ProductView<V> PostingIndex<K, V, Map>::View(const K& key) const
+{
+	const vector<const V*>& list = Get(key);
+	return ProductView<V>(list.data(), list.data() + list.size());
+}
+
+template<typename K, typename V, typename Map>
+size_t PostingIndex<K, V, Map>::Count(const K& key) const
+{
+	return Get(key).size();
+}
+
+template<typename K, typename V, typename Map>
+template<typename F>
+void PostingIndex<K, V, Map>::ForEach(F f) const
+{
+	for (typename Map::const_iterator it = postings.begin(); it != postings.end(); it++) { f(it->first, it->second); }
+}
+
+template<typename K, typename V, typename Map>
+size_t PostingIndex<K, V, Map>::KeyCount() const
+{
+	return postings.size();
+}
+
+template<typename K, typename V, typename Map>
+void PostingIndex<K, V, Map>::Assign(const K& key, vector<const V*> products)
+{
+	postings[key].swap(products);
+}
+
+template<typename K, typename V, typename Map>
+void PostingIndex<K, V, Map>::Clear()
+{
+	postings.clear();
+}
+
+/**
+ * Ordered index over an attribute, for range queries in O(log n + k).
+ * Keys and products are kept in two parallel arrays sorted by key (ties in the order the products were added), so a
+ * query is two binary searches over a dense key array, and its result is a view of the matching slice of products.
+ * A third parallel array holds the products' ordinals, so that the sorted order can be saved and restored as is.
+ * Adds in key order just append; an out-of-order Add defers the sort to the next query, so loading a service costs
+ * one sort instead of an insertion per product. That lazy sort mutates the index, so concurrent queries are only safe
+ * once Finalize (or a first query) has been made after the last Add.
+ * Uses key generic type K, which must be ordered, and product type V.
+ */
+template<typename K, typename V>
+class RangeIndex
+{
+public:
+	// RangeIndex ctor
+	RangeIndex();
+
+	// Add a product with the given key and ordinal
+	void Add(const K& key, const V* product, uint32_t ordinal);
+
+	// Make room for the given number of products without reallocating
+	void Reserve(size_t count);
+
+	// Replace the contents with products already in key order, e.g. restored from a snapshot; they are only sorted
+	// again if they turn out not to be in order
+	void Assign(vector<K> sortedKeys, vector<const V*> sortedProducts, vector<uint32_t> sortedOrdinals);
+
+	// Return the ordinals of the products in key order
+	const vector<uint32_t>& Ordinals() const;
+
+	// Sort now rather than on the next query, so that queries from several threads after a bulk load do not race on
+	// the lazy sort
+	void Finalize();
+
+	// Return the products with a key between low and high; each bound is included or excluded as specified
+	ProductView<V> Range(const K& low, bool lowInclusive, const K& high, bool highInclusive) const;
+
+	// Return the products with a key greater than the given key (or equal to it, if inclusive)
+	ProductView<V> Above(const K& key, bool inclusive) const;
+
+	// Return the products with a key less than the given key (or equal to it, if inclusive)
+	ProductView<V> Below(const K& key, bool inclusive) const;
+
+	// Split the products between the increasing bounds b0 < b1 < ... < bn into n buckets: bucket i holds the keys in
+	// [bi, bi+1), except the last bucket which also includes bn, e.g. bounds 2, 5, 10, 30 give 2-5, 5-10 and 10-30
+	vector<ProductView<V> > Buckets(const vector<K>& bounds) const;
+
+	// Return the number of products in the index
+	size_t Size() const;
+
+private:
+	// Sort the arrays by key if an out-of-order Add left them unsorted
+	void Sort() const;
+
+	// Return the products at the positions [first, last) of the sorted arrays
+	ProductView<V> Slice(size_t first, size_t last) const;
+
+	// Position of the first key not before the given key (inclusive) or after it (exclusive)
+	size_t LowerPosition(const K& key, bool inclusive) const;
+
+	// Position after the last key not after the given key (inclusive) or before it (exclusive)
+	size_t UpperPosition(const K& key, bool inclusive) const;
+
+	mutable vector<K> keys; // sorted keys, once sorted is true
+	mutable vector<const V*> products; // product of each key
+	mutable vector<uint32_t> ordinals; // ordinal of each product, so the order can be saved
+	mutable bool sorted; // whether keys are in order
+
+};
+
+template<typename K, typename V>
+RangeIndex<K, V>::RangeIndex() :
+	sorted(true)
+{
+}
+
+template<typename K, typename V>
+void RangeIndex<K, V>::Add(const K& key, const V* product, uint32_t ordinal)
+{
+	if (sorted && !keys.empty() && key < keys.back()) { sorted = false; }
+	keys.push_back(key);
+	products.push_back(product);
+	ordinals.push_back(ordinal);
+}
+
+template<typename K, typename V>
+void RangeIndex<K, V>::Reserve(size_t count)
+{
+	keys.reserve(count);
+	products.reserve(count);
+	ordinals.reserve(count);
+}
+
+template<typename K, typename V>
+void RangeIndex<K, V>::Assign(vector<K> sortedKeys, vector<const V*> sortedProducts, vector<uint32_t> sortedOrdinals)
+{
+	keys.swap(sortedKeys);
+	products.swap(sortedProducts);
+	ordinals.swap(sortedOrdinals);
+	sorted = is_sorted(keys.begin(), keys.end());
+}
+
+template<typename K, typename V>
+const vector<uint32_t>& RangeIndex<K, V>::Ordinals() const
+{
+	Sort();
+	return ordinals;
+}
+
+template<typename K, typename V>
+void RangeIndex<K, V>::Finalize()
+{
+	Sort();
+}
+
+template<typename K, typename V>
+ProductView<V> RangeIndex<K, V>::Range(const K& low, bool lowInclusive, const K& high, bool highInclusive) const
+{
+	Sort();
+	return Slice(LowerPosition(low, lowInclusive), UpperPosition(high, highInclusive));
+}
+
+template<typename K, typename V>
+ProductView<V> RangeIndex<K, V>::Above(const K& key, bool inclusive) const
+{
+	Sort();
+	return Slice(LowerPosition(key, inclusive), keys.size());
+}
+
+template<typename K, typename V>
+ProductView<V> RangeIndex<K, V>::Below(const K& key, bool inclusive) const
+{
+	Sort();
+	return Slice(0, UpperPosition(key, inclusive));
+}
+
+template<typename K, typename V>
+vector<ProductView<V> > RangeIndex<K, V>::Buckets(const vector<K>& bounds) const
+{
+	Sort();
+	vector<ProductView<V> > buckets;
+	for (size_t i = 0; i + 1 < bounds.size(); i++)
+	{
+		const bool last = i + 2 == bounds.size();
+		buckets.push_back(Slice(LowerPosition(bounds[i], true), UpperPosition(bounds[i + 1], last)));
+	}
+	return buckets;
+}
+
+template<typename K, typename V>
+size_t RangeIndex<K, V>::Size() const
+{
+	return keys.size();
+}
+
+template<typename K, typename V>
+void RangeIndex<K, V>::Sort() const
+{
+	if (sorted) { return; }
+	vector<size_t> order(keys.size());
+	for (size_t i = 0; i < order.size(); i++) { order[i] = i; }
+	stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+	vector<K> sortedKeys;
+	vector<const V*> sortedProducts;
+	vector<uint32_t> sortedOrdinals;
+	sortedKeys.reserve(keys.size());
+	sortedProducts.reserve(products.size());
+	sortedOrdinals.reserve(ordinals.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		sortedKeys.push_back(keys[order[i]]);
+		sortedProducts.push_back(products[order[i]]);
+		sortedOrdinals.push_back(ordinals[order[i]]);
+	}
+	keys.swap(sortedKeys);
+	products.swap(sortedProducts);
+	ordinals.swap(sortedOrdinals);
+	sorted = true;
+}
+
+template<typename K, typename V>
+ProductView<V> RangeIndex<K, V>::Slice(size_t first, size_t last) const
+{
+	if (first >= last) { return ProductView<V>(); }
+	return ProductView<V>(products.data() + first, products.data() + last);
+}
+
+template<typename K, typename V>
+size_t RangeIndex<K, V>::LowerPosition(const K& key, bool inclusive) const
+{
+	return (inclusive ? lower_bound(keys.begin(), keys.end(), key) : upper_bound(keys.begin(), keys.end(), key)) - keys.begin();
+}
+
+template<typename K, typename V>
+size_t RangeIndex<K, V>::UpperPosition(const K& key, bool inclusive) const
+{
+	return (inclusive ? upper_bound(keys.begin(), keys.end(), key) : lower_bound(keys.begin(), keys.end(), key)) - keys.begin();
+}
+
+/**
+ * Bitmap index from an attribute value to the ordinals of the products having that value.
+ * Ordinals are assigned by the service in the order products are added, so they index its product table.
+ * Uses key generic type K, which must be ordered so that range unions (Above, Below) can walk the keys in order.
+ */
+template<typename K>
+class BitmapIndex
+{
+public:
+	// Add a product ordinal to the bitmap of the given key
+	void Add(const K& key, uint32_t ordinal);
+
+	// Replace the bitmap of the given key, e.g. with one restored from a snapshot
+	void Assign(const K& key, Bitmap ordinals);
+
+	// Return the bitmap of the given key (an empty bitmap if no product has that key)
+	const Bitmap& Get(const K& key) const;
+
+	// Call f(key, bitmap) for every key that has products, in key order
+	template<typename F>
+	void ForEach(F f) const;
+
+	// Return the union of the bitmaps of all keys greater than the given key
+	Bitmap Above(const K& key) const;
+
+	// Return the union of the bitmaps of all keys less than the given key
+	Bitmap Below(const K& key) const;
+
+	// Return the union of the bitmaps of all keys not less than the given key
+	Bitmap AtLeast(const K& key) const;
+
+	// Return the union of the bitmaps of all keys not greater than the given key
+	Bitmap AtMost(const K& key) const;
+
+	// Return the number of distinct keys, and of distinct keys greater or less than the given key; a range query can
+	// union whichever side of the split has fewer bitmaps
+	size_t KeyCount() const;
+	size_t KeysAbove(const K& key) const;
+	size_t KeysBelow(const K& key) const;
+
+private:
+	map<K, Bitmap> bitmaps; // bitmap per key
+
+};
+
+template<typename K>
+void BitmapIndex<K>::Add(const K& key, uint32_t ordinal)
+{
+	bitmaps[key].Add(ordinal);
+}
+
+template<typename K>
+void BitmapIndex<K>::Assign(const K& key, Bitmap ordinals)
+{
+	bitmaps[key] = move(ordinals);
+}
+
+template<typename K>
+template<typename F>
+void BitmapIndex<K>::ForEach(F f) const
+{
+	for (typename map<K, Bitmap>::const_iterator it = bitmaps.begin(); it != bitmaps.end(); it++) { f(it->first, it->second); }
+}
+
+template<typename K>
+const Bitmap& BitmapIndex<K>::Get(const K& key) const
+{
+	static const Bitmap empty;
+	typename map<K, Bitmap>::const_iterator it = bitmaps.find(key);
+	return it == bitmaps.end() ? empty : it->second;
+}
+
+template<typename K>
+Bitmap BitmapIndex<K>::Above(const K& key) const
+{
+	Bitmap result;
+	for (typename map<K, Bitmap>::const_iterator it = bitmaps.upper_bound(key); it != bitmaps.end(); it++) { result |= it->second; }
+	return result;
+}
+
+template<typename K>
+Bitmap BitmapIndex<K>::Below(const K& key) const
+{
+	Bitmap result;
+	for (typename map<K, Bitmap>::const_iterator it = bitmaps.begin(); it != bitmaps.lower_bound(key); it++) { result |= it->second; }
+	return result;
+}
+
+template<typename K>
+Bitmap BitmapIndex<K>::AtLeast(const K& key) const
+{
+	Bitmap result;
+	for (typename map<K, Bitmap>::const_iterator it = bitmaps.lower_bound(key); it != bitmaps.end(); it++) { result |= it->second; }
+	return result;
+}
+
+template<typename K>
+Bitmap BitmapIndex<K>::AtMost(const K& key) const
+{
+	Bitmap result;
+	for (typename map<K, Bitmap>::const_iterator it = bitmaps.begin(); it != bitmaps.upper_bound(key); it++) { result |= it->second; }
+	return result;
+}
+
+template<typename K>
+size_t BitmapIndex<K>::KeyCount() const
+{
+	return bitmaps.size();
+}
+
+template<typename K>
+size_t BitmapIndex<K>::KeysAbove(const K& key) const
+{
+	return distance(bitmaps.upper_bound(key), bitmaps.end());
+}
+
+template<typename K>
+size_t BitmapIndex<K>::KeysBelow(const K& key) const
+{
+	return distance(bitmaps.begin(), bitmaps.lower_bound(key));
+}
+
+/**
+ * Base of the fluent product queries (SwapQuery, BondQuery).
+ * A query starts from every product of the service; each predicate of the derived class combines the bitmap of the
+ * matching ordinals into the running result with a single bitmap operation (AND, or AND NOT after Not()), and Or merges
+ * in the result of another query. Results resolves the final ordinals to pointers into the service, without copying
+ * any product.
+ * Uses product type V and the derived query type Q, which predicates and Not/Or return for chaining.
+ */
+template<typename V, typename Q>
+class ProductQuery
+{
+public:
+	// Negate the next predicate
+	Q& Not();
+
+	// Keep the products matched by this query or by the other one
+	Q& Or(const Q& other);
+
+	// Return the number of matching products
+	size_t Count() const;
+
+	// Return the matching products, in the order they were added to the service
+	vector<const V*> Results() const;
+
+	// Call f(product) for every matching product, in the order they were added to the service, without allocating
+	template<typename F>
+	void ForEach(F f) const;
+
+	// Return the ordinals of the matching products
+	const Bitmap& Matches() const;
+
+protected:
+	// ctor over the service's product table (indexed by ordinal) and the bitmap of all its ordinals
+	ProductQuery(const vector<const V*>& _products, const Bitmap& _all);
+
+	// Apply a predicate given by the bitmap of the products satisfying it
+	Q& Combine(const Bitmap& _matching);
+
+private:
+	const vector<const V*>* products; // product table of the service
+	const Bitmap* all; // ordinals of every product of the service
+	Bitmap matches; // products matching every predicate so far, unless unrestricted
+	bool unrestricted; // no predicate applied yet: every product matches, and all is used instead of a copy in matches
+	bool negateNext; // whether the next predicate is negated
+
+};
+
+template<typename V, typename Q>
+ProductQuery<V, Q>::ProductQuery(const vector<const V*>& _products, const Bitmap& _all) :
+	products(&_products), all(&_all), unrestricted(true), negateNext(false)
+{
+}
+
+template<typename V, typename Q>
+Q& ProductQuery<V, Q>::Not()
+{
+	negateNext = !negateNext;
+	return static_cast<Q&>(*this);
+}
+
+template<typename V, typename Q>
+Q& ProductQuery<V, Q>::Or(const Q& other)
+{
+	if (!unrestricted)
+	{
+		if (other.unrestricted) { unrestricted = true; matches = Bitmap(); }
+		else { matches |= other.matches; }
+	}
+	return static_cast<Q&>(*this);
+}
+
+template<typename V, typename Q>
+size_t ProductQuery<V, Q>::Count() const
+{
+	return Matches().Cardinality();
+}
+
+template<typename V, typename Q>
+vector<const V*> ProductQuery<V, Q>::Results() const
+{
+	vector<const V*> results;
+	results.reserve(Count());
+	const vector<const V*>& table = *products;
+	Matches().ForEach([&results, &table](uint32_t ordinal) { results.push_back(table[ordinal]); });
+	return results;
+}
+
+template<typename V, typename Q>
+template<typename F>
+void ProductQuery<V, Q>::ForEach(F f) const
+{
+	const vector<const V*>& table = *products;
+	Matches().ForEach([&f, &table](uint32_t ordinal) { f(*table[ordinal]); });
+}
+
+template<typename V, typename Q>
+const Bitmap& ProductQuery<V, Q>::Matches() const
+{
+	return unrestricted ? *all : matches;
+}
+
+template<typename V, typename Q>
+Q& ProductQuery<V, Q>::Combine(const Bitmap& _matching)
+{
+	if (unrestricted)
+	{
+		matches = negateNext ? AndNot(*all, _matching) : _matching;
+		unrestricted = false;
+	}
+	else
+	{
+		if (negateNext) { matches -= _matching; }
+		else { matches &= _matching; }
+	}
+	negateNext = false;
+	return static_cast<Q&>(*this);
+}
+
+#endif
@@ -0,0 +1,333 @@
+/**
+ * productloader.hpp loads product universes from CSV files into the ProductServices.
+ * The file is memory-mapped and split into chunks at line boundaries; the chunks are parsed in parallel (one thread per
+ * chunk, without iostreams) into products, which are then added to the service in file order.
+ *
+ * One product per line, fields separated by commas, enums written as their enumerator names, dates as YYYY-MM-DD or
+ * YYYYMMDD. Empty lines, lines starting with '#' and header lines whose first field is productId are skipped.
+ *   Bond:   productId,bondIdType,ticker,coupon,maturityDate
+ *           912828M56,CUSIP,T,2.25,2025-11-16
+ *   IRSwap: productId,fixedLegDayCountConvention,floatingLegDayCountConvention,fixedLegPaymentFrequency,floatingIndex,
+ *           floatingIndexTenor,effectiveDate,terminationDate,currency,termYears,swapType,swapLegType
+ *           Spot-Outright-10Y,THIRTY_THREE_SIXTY,THIRTY_THREE_SIXTY,SEMI_ANNUAL,LIBOR,TENOR_3M,2015-11-16,2025-11-16,USD,10,SPOT,OUTRIGHT
+ *   Future: productId,futureType,futureExchange,multiplier,maturityDate
+ *           CLZ5,COMMODITY,NYMEX,1000,2025-11-20
+ * Build with -pthread where the C library needs it.
+ */
+
+#ifndef PRODUCTLOADER_HPP
+#define PRODUCTLOADER_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "mappedfile.hpp"
+#include "products.hpp"
+#include "productservice.hpp"
+
+using namespace std;
+
+// Enumerator names of the enums, in declaration order, as written in the CSV files
+static const char* const BOND_ID_TYPE_NAMES[] = { "CUSIP", "ISIN" };
+static const char* const DAY_COUNT_CONVENTION_NAMES[] = { "THIRTY_THREE_SIXTY", "ACT_THREE_SIXTY", "ACT_THREE_SIXTY_FIVE" };
+static const char* const PAYMENT_FREQUENCY_NAMES[] = { "QUARTERLY", "SEMI_ANNUAL", "ANNUAL" };
+static const char* const FLOATING_INDEX_NAMES[] = { "LIBOR", "EURIBOR" };
+static const char* const FLOATING_INDEX_TENOR_NAMES[] = { "TENOR_1M", "TENOR_3M", "TENOR_6M", "TENOR_12M" };
+static const char* const CURRENCY_NAMES[] = { "USD", "EUR", "GBP" };
+static const char* const SWAP_TYPE_NAMES[] = { "SPOT", "FORWARD", "IMM", "MAC", "BASIS" };
+static const char* const SWAP_LEG_TYPE_NAMES[] = { "OUTRIGHT", "CURVE", "FLY" };
+static const char* const FUTURE_TYPE_NAMES[] = { "EQUITY", "COMMODITY", "CURRENCY", "RATE", "METAL", "TREASURY" };
+static const char* const FUTURE_EXCHANGE_NAMES[] = { "CBOT", "CME", "NYMEX", "COMEX", "ICE" };
+
+// Number of fields of a Bond, IRSwap and Future line
+const size_t BOND_CSV_FIELDS = 5;
+const size_t IRSWAP_CSV_FIELDS = 12;
+const size_t FUTURE_CSV_FIELDS = 5;
+const size_t MAX_CSV_FIELDS = 12;
+
+// Files smaller than this per thread are parsed by fewer threads, so small files are not split at all
+const size_t MIN_CSV_CHUNK_BYTES = 1 << 20;
+
+// Split a CSV line into fields, trimming the spaces around each; returns the number of fields, which is more than
+// _maxFields (and the extra fields are not stored) if the line has too many
+inline size_t SplitCsvLine(string_view _line, string_view* _fields, size_t _maxFields)
+{
+	size_t count = 0;
+	size_t position = 0;
+	while (true)
+	{
+		size_t comma = _line.find(',', position);
+		string_view field = _line.substr(position, comma == string_view::npos ? string_view::npos : comma - position);
+		while (!field.empty() && field.front() == ' ') { field.remove_prefix(1); }
+		while (!field.empty() && field.back() == ' ') { field.remove_suffix(1); }
+		if (count < _maxFields) { _fields[count] = field; }
+		count++;
+		if (comma == string_view::npos) { return count; }
+		position = comma + 1;
+	}
+}
+
+// Parse an integer field; throws invalid_argument naming the column if it is not one
+inline int ParseCsvInt(string_view _field, const char* _column)
+{
+	int value = 0;
+	from_chars_result result = from_chars(_field.data(), _field.data() + _field.size(), value);
+	if (result.ec != errc() || result.ptr != _field.data() + _field.size() || _field.empty())
+	{
+		throw invalid_argument(string("bad ") + _column + " '" + string(_field) + "'");
+	}
+	return value;
+}
+
+// Parse a decimal field; throws invalid_argument naming the column if it is not one. Uses the locale-independent
+// from_chars where the standard library has it for floating point, strtof on a bounded copy otherwise.
+inline float ParseCsvFloat(string_view _field, const char* _column)
+{
+	float value = 0;
+	bool parsed = false;
+#if defined(__cpp_lib_to_chars)
+	from_chars_result result = from_chars(_field.data(), _field.data() + _field.size(), value);
+	parsed = result.ec == errc() && result.ptr == _field.data() + _field.size();
+#else
+	char buffer[64];
+	if (_field.size() < sizeof(buffer))
+	{
+		memcpy(buffer, _field.data(), _field.size());
+		buffer[_field.size()] = '\0';
+		char* end = nullptr;
+		value = strtof(buffer, &end);
+		parsed = end == buffer + _field.size();
+	}
+#endif
+	if (!parsed || _field.empty()) { throw invalid_argument(string("bad ") + _column + " '" + string(_field) + "'"); }
+	return value;
+}
+
+// Parse a YYYY-MM-DD or YYYYMMDD date field; throws invalid_argument naming the column if it is not one, or the
+// out_of_range of the date library if the day does not exist
+inline date ParseCsvDate(string_view _field, const char* _column)
+{
+	if (_field.size() == 10 && _field[4] == '-' && _field[7] == '-')
+	{
+		return date(ParseCsvInt(_field.substr(0, 4), _column), ParseCsvInt(_field.substr(5, 2), _column), ParseCsvInt(_field.substr(8, 2), _column));
+	}
+	if (_field.size() == 8)
+	{
+		return date(ParseCsvInt(_field.substr(0, 4), _column), ParseCsvInt(_field.substr(4, 2), _column), ParseCsvInt(_field.substr(6, 2), _column));
+	}
+	throw invalid_argument(string("bad ") + _column + " '" + string(_field) + "'");
+}
+
+// Parse an enum field written as one of its enumerator names; throws invalid_argument naming the column otherwise
+template<typename E, size_t N>
+E ParseCsvEnum(string_view _field, const char* const (&_names)[N], const char* _column)
+{
+	for (size_t i = 0; i < N; i++)
+	{
+		if (_field == _names[i]) { return static_cast<E>(i); }
+	}
+	throw invalid_argument(string("bad ") + _column + " '" + string(_field) + "'");
+}
+
+// Build a Bond from the fields of a Bond line
+inline Bond ParseBondFields(const string_view* _fields)
+{
+	return Bond(string(_fields[0]), ParseCsvEnum<BondIdType>(_fields[1], BOND_ID_TYPE_NAMES, "bondIdType"), string(_fields[2]),
+	            ParseCsvFloat(_fields[3], "coupon"), ParseCsvDate(_fields[4], "maturityDate"));
+}
+
+// Build an IRSwap from the fields of an IRSwap line
+inline IRSwap ParseIRSwapFields(const string_view* _fields)
+{
+	return IRSwap(string(_fields[0]), ParseCsvEnum<DayCountConvention>(_fields[1], DAY_COUNT_CONVENTION_NAMES, "fixedLegDayCountConvention"),
+	              ParseCsvEnum<DayCountConvention>(_fields[2], DAY_COUNT_CONVENTION_NAMES, "floatingLegDayCountConvention"),
+	              ParseCsvEnum<PaymentFrequency>(_fields[3], PAYMENT_FREQUENCY_NAMES, "fixedLegPaymentFrequency"),
+	              ParseCsvEnum<FloatingIndex>(_fields[4], FLOATING_INDEX_NAMES, "floatingIndex"),
+	              ParseCsvEnum<FloatingIndexTenor>(_fields[5], FLOATING_INDEX_TENOR_NAMES, "floatingIndexTenor"),
+	              ParseCsvDate(_fields[6], "effectiveDate"), ParseCsvDate(_fields[7], "terminationDate"),
+	              ParseCsvEnum<Currency>(_fields[8], CURRENCY_NAMES, "currency"), ParseCsvInt(_fields[9], "termYears"),
+	              ParseCsvEnum<SwapType>(_fields[10], SWAP_TYPE_NAMES, "swapType"), ParseCsvEnum<SwapLegType>(_fields[11], SWAP_LEG_TYPE_NAMES, "swapLegType"));
+}
+
+// Build a Future from the fields of a Future line
+inline Future ParseFutureFields(const string_view* _fields)
+{
+	return Future(string(_fields[0]), ParseCsvEnum<FutureType>(_fields[1], FUTURE_TYPE_NAMES, "futureType"),
+	              ParseCsvEnum<FutureExchange>(_fields[2], FUTURE_EXCHANGE_NAMES, "futureExchange"), ParseCsvInt(_fields[3], "multiplier"),
+	              ParseCsvDate(_fields[4], "maturityDate"));
+}
+
+/**
+ * Products parsed from one chunk of a CSV file, with the number of lines the chunk spans and the first error in it.
+ * Uses product type T.
+ */
+template<typename T>
+struct CsvChunk
+{
+	vector<T> products; // products in line order
+	size_t lines = 0; // lines read, up to the error if there is one
+	string error; // description of the first malformed line, empty if there is none
+};
+
+// Parse the lines of a chunk of CSV text, stopping at the first malformed line
+template<typename T, typename FieldParser>
+void ParseCsvChunk(string_view _text, size_t _fieldCount, FieldParser _parseFields, CsvChunk<T>& _chunk)
+{
+	string_view fields[MAX_CSV_FIELDS];
+	size_t position = 0;
+	while (position < _text.size())
+	{
+		size_t lineEnd = _text.find('\n', position);
+		if (lineEnd == string_view::npos) { lineEnd = _text.size(); }
+		string_view line = _text.substr(position, lineEnd - position);
+		position = lineEnd + 1;
+		_chunk.lines++;
+
+		if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
+		if (line.empty() || line.front() == '#') { continue; }
+		const size_t count = SplitCsvLine(line, fields, MAX_CSV_FIELDS);
+		if (fields[0] == "productId") { continue; }
+		try
+		{
+			if (count != _fieldCount) { throw invalid_argument("expected " + to_string(_fieldCount) + " fields, found " + to_string(count)); }
+			_chunk.products.push_back(_parseFields(fields));
+		}
+		catch (const exception& e)
+		{
+			_chunk.error = e.what();
+			return;
+		}
+	}
+}
+
+// Parse CSV text into products, one chunk per thread (0 threads: one per hardware thread), and return the products of
+// each chunk in file order. Throws invalid_argument naming the source and line number of the first malformed line.
+template<typename T, typename FieldParser>
+vector<vector<T> > ParseCsvChunks(string_view _text, size_t _fieldCount, FieldParser _parseFields, unsigned _threads, const string& _source)
+{
+	if (_threads == 0) { _threads = max(1u, thread::hardware_concurrency()); }
+	const size_t chunkCount = max<size_t>(1, min<size_t>(_threads, _text.size() / MIN_CSV_CHUNK_BYTES));
+
+	// Cut the text after the first line end following each even split point
+	vector<string_view> texts;
+	size_t first = 0;
+	for (size_t i = 1; i <= chunkCount && first < _text.size(); i++)
+	{
+		size_t last = _text.size();
+		if (i < chunkCount)
+		{
+			size_t lineEnd = _text.find('\n', max(first, _text.size() / chunkCount * i));
+			if (lineEnd != string_view::npos) { last = lineEnd + 1; }
+		}
+		texts.push_back(_text.substr(first, last - first));
+		first = last;
+	}
+
+	// The calling thread parses the first chunk while workers parse the others
+	vector<CsvChunk<T> > chunks(texts.size());
+	vector<thread> workers;
+	for (size_t i = 1; i < texts.size(); i++)
+	{
+		try
+		{
+			workers.push_back(thread([&texts, &chunks, &_parseFields, _fieldCount, i]() { ParseCsvChunk(texts[i], _fieldCount, _parseFields, chunks[i]); }));
+		}
+		catch (const system_error&)
+		{
+			ParseCsvChunk(texts[i], _fieldCount, _parseFields, chunks[i]); // no thread available: parse it here
+		}
+	}
+	if (!texts.empty()) { ParseCsvChunk(texts[0], _fieldCount, _parseFields, chunks[0]); }
+	for (vector<thread>::iterator it = workers.begin(); it != workers.end(); it++) { it->join(); }
+
+	vector<vector<T> > return_vecs;
+	return_vecs.reserve(chunks.size());
+	size_t lineOffset = 0;
+	for (typename vector<CsvChunk<T> >::iterator it = chunks.begin(); it != chunks.end(); it++)
+	{
+		if (!it->error.empty()) { throw invalid_argument(_source + ":" + to_string(lineOffset + it->lines) + ": " + it->error); }
+		lineOffset += it->lines;
+		return_vecs.push_back(move(it->products));
+	}
+	return return_vecs;
+}
+
+// Parse CSV text into products in file order
+template<typename T, typename FieldParser>
+vector<T> ParseCsv(string_view _text, size_t _fieldCount, FieldParser _parseFields, unsigned _threads, const string& _source)
+{
+	vector<vector<T> > chunks = ParseCsvChunks<T>(_text, _fieldCount, _parseFields, _threads, _source);
+	if (chunks.size() == 1) { return move(chunks[0]); }
+	vector<T> return_vec;
+	for (typename vector<vector<T> >::iterator it = chunks.begin(); it != chunks.end(); it++)
+	{
+		return_vec.insert(return_vec.end(), make_move_iterator(it->begin()), make_move_iterator(it->end()));
+	}
+	return return_vec;
+}
+
+// Map a CSV file, parse it in parallel and add its products to the service in file order, after reserving room for
+// them, then finalize the service so that it can be queried from several threads; returns the number of products added (lines whose productId is already known are skipped)
+template<typename T, typename S, typename FieldParser>
+size_t LoadCsv(const string& _path, S& _service, size_t _fieldCount, FieldParser _parseFields, unsigned _threads)
+{
+	MappedFile file(_path);
+	vector<vector<T> > chunks = ParseCsvChunks<T>(file.Contents(), _fieldCount, _parseFields, _threads, _path);
+	size_t total = 0;
+	for (typename vector<vector<T> >::const_iterator it = chunks.begin(); it != chunks.end(); it++) { total += it->size(); }
+
+	const size_t before = _service.Size();
+	_service.Reserve(before + total);
+	for (typename vector<vector<T> >::iterator chunk = chunks.begin(); chunk != chunks.end(); chunk++)
+	{
+		for (typename vector<T>::iterator it = chunk->begin(); it != chunk->end(); it++) { _service.Add(move(*it)); }
+	}
+	_service.Finalize();
+	return _service.Size() - before;
+}
+
+// Parse Bond, IRSwap or Future lines held in memory, in order, with the given number of threads (0: one per hardware
+// thread); throws invalid_argument naming the first malformed line
+inline vector<Bond> ParseBonds(string_view _text, unsigned _threads = 0)
+{
+	return ParseCsv<Bond>(_text, BOND_CSV_FIELDS, ParseBondFields, _threads, "bonds");
+}
+
+inline vector<IRSwap> ParseIRSwaps(string_view _text, unsigned _threads = 0)
+{
+	return ParseCsv<IRSwap>(_text, IRSWAP_CSV_FIELDS, ParseIRSwapFields, _threads, "swaps");
+}
+
+inline vector<Future> ParseFutures(string_view _text, unsigned _threads = 0)
+{
+	return ParseCsv<Future>(_text, FUTURE_CSV_FIELDS, ParseFutureFields, _threads, "futures");
+}
+
+// Load a Bond, IRSwap or Future CSV file into the service with the given number of threads (0: one per hardware
+// thread); returns the number of products added. Throws runtime_error if the file cannot be read, and invalid_argument
+// naming the first malformed line, in which case nothing is added.
+inline size_t LoadBonds(const string& _path, BondProductService& _service, unsigned _threads = 0)
+{
+	return LoadCsv<Bond>(_path, _service, BOND_CSV_FIELDS, ParseBondFields, _threads);
+}
+
+inline size_t LoadIRSwaps(const string& _path, IRSwapProductService& _service, unsigned _threads = 0)
+{
+	return LoadCsv<IRSwap>(_path, _service, IRSWAP_CSV_FIELDS, ParseIRSwapFields, _threads);
+}
+
+inline size_t LoadFutures(const string& _path, FutureProductService& _service, unsigned _threads = 0)
+{
+	return LoadCsv<Future>(_path, _service, FUTURE_CSV_FIELDS, ParseFutureFields, _threads);
+}
+
+#endif
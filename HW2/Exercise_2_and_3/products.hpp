@@ -200,7 +200,7 @@ Bond::Bond(string _productId, BondIdType _bondIdType, string _ticker, float _cou
     maturityDate = _maturityDate;
 }
 
-Bond::Bond() : Product(0, BOND)
+Bond::Bond() : Product("", BOND)
 {
 }
 
@@ -245,7 +245,7 @@ IRSwap::IRSwap(string _productId, DayCountConvention _fixedLegDayCountConvention
     swapLegType = _swapLegType;
 }
 
-IRSwap::IRSwap() : Product(0, IRSWAP)
+IRSwap::IRSwap() : Product("", IRSWAP)
 {
 }
 
@@ -435,7 +435,7 @@ Future::Future(string _productId, FutureType _futureType, FutureExchange _future
     maturityDate = _maturityDate;
 }
 
-Future::Future() : Product(0, FUTURE)
+Future::Future() : Product("", FUTURE)
 {
 }
 
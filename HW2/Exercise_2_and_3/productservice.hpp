@@ -2,52 +2,102 @@
  * productservice.hpp defines Bond and IRSwap ProductServices
  */
 
+#ifndef PRODUCTSERVICE_HPP
+#define PRODUCTSERVICE_HPP
+
+#include <functional>
 #include <iostream>
 #include <map>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
 #include "products.hpp"
-#include "soa.hpp"
+#include "genericproductservice.hpp"
+#include "swapcolumns.hpp"
+
+class BondQuery;
+class SwapQuery;
 
  /**
   * Bond Product Service to own reference data over a set of bond securities.
-  * Key is the productId string, value is a Bond.
+  * Key is the productId string, value is a Bond, held in a hash map by the ProductService base, which maintains the
+  * ticker, id type and maturity indexes.
+  * Ticker queries are answered from a hash index maintained on Add, so they cost O(result size) whatever the number of
+  * bonds; their results are in the order the bonds were added.
+  * The View methods return the same results as views of the indexes, without copying or allocating; a view is
+  * invalidated by the next Add.
   */
-class BondProductService : public Service<string, Bond>
+class BondProductService : public ProductService<Bond, IndexOn<&Bond::GetTicker>, IndexOn<&Bond::GetBondIdType>, RangeOn<&Bond::GetMaturityDate> >
 {
 
 public:
 	// BondProductService ctor
 	BondProductService();
 
-	// Return the bond data for a particular bond product identifier
-	Bond& GetData(string productId);
-
 	// Add a bond to the service (convenience method)
 	void Add(Bond& bond);
 
+	// Add a bond to the service, moving it instead of copying it
+	void Add(Bond&& bond);
+
 	// Q3.1 Get all Bonds with the specified ticker
 	vector<Bond> GetBonds(string& _ticker);
 
-private:
-	map<string, Bond> bondMap; // cache of bond products
+	// Get all Bonds with the specified ticker without copying them; the list is owned by the service and grows with Add
+	const vector<const Bond*>& GetBondsByTicker(const string& _ticker) const;
+
+	// Get the number of Bonds with the specified ticker in O(1)
+	size_t GetBondCount(const string& _ticker) const;
+
+	// Get the number of Bonds of every ticker, in O(number of tickers)
+	vector<pair<string, size_t> > GetBondCountsByTicker() const;
+
+	// Get all Bonds maturing between the specified dates, in maturity order; each bound is included or excluded as specified
+	vector<Bond> GetBondsMaturingBetween(date _low, date _high, bool _lowInclusive = true, bool _highInclusive = true);
+
+	// Get the Bonds in maturity buckets between increasing dates, see RangeIndex::Buckets
+	vector<vector<Bond> > GetBondsByMaturityBuckets(const vector<date>& _bounds);
+
+	// View all Bonds with the specified ticker
+	ProductView<Bond> ViewBonds(const string& _ticker) const;
+
+	// View all Bonds maturing between the specified dates, in maturity order
+	ProductView<Bond> ViewBondsMaturingBetween(date _low, date _high, bool _lowInclusive = true, bool _highInclusive = true) const;
+
+	// Start a multi-predicate query over all bonds, e.g. Query().WithTicker("T").WithBondIdType(CUSIP).Results()
+	BondQuery Query() const;
 
 };
 
 /**
  * Interest Rate Swap Product Service to own reference data over a set of IR Swap products
- * Key is the productId string, value is a IRSwap.
+ * Key is the productId string, value is a IRSwap, held in a hash map by the ProductService base, which maintains the
+ * attribute, term and termination date indexes.
+ * Attribute queries (Q3.2-Q3.4, Q3.7, Q3.8) are answered from secondary indexes maintained on Add, so they cost
+ * O(result size); their results are in the order the swaps were added.
+ * Term and termination date queries (Q3.5, Q3.6 and the range and bucket queries) use sorted range indexes and cost
+ * O(log n + result size); their results are in term or termination date order.
+ * The View methods return the same results as views of the indexes, without copying or allocating; a view is
+ * invalidated by the next Add.
+ * A columnar copy of the swap attributes (StoreIn<IRSwapColumns>, kept row for row with the ordinals by every Insert)
+ * answers arbitrary SwapFilter conditions with a vectorized scan (ScanSwaps).
  */
-class IRSwapProductService : public Service<string, IRSwap>
+class IRSwapProductService : public ProductService<IRSwap,
+	IndexOn<&IRSwap::GetFixedLegDayCountConvention>, IndexOn<&IRSwap::GetFloatingLegDayCountConvention>,
+	IndexOn<&IRSwap::GetFixedLegPaymentFrequency>, IndexOn<&IRSwap::GetFloatingIndex>, IndexOn<&IRSwap::GetFloatingIndexTenor>,
+	IndexOn<&IRSwap::GetCurrency>, IndexOn<&IRSwap::GetSwapType>, IndexOn<&IRSwap::GetSwapLegType>, IndexOn<&IRSwap::GetTermYears>,
+	RangeOn<&IRSwap::GetTermYears>, RangeOn<&IRSwap::GetTerminationDate>, StoreIn<IRSwapColumns> >
 {
 public:
 	// IRSwapProductService ctor
 	IRSwapProductService();
 
-	// Return the IR Swap data for a particular bond product identifier
-	IRSwap& GetData(string productId);
-
 	// Add a bond to the service (convenience method)
 	void Add(IRSwap& swap);
 
+	// Add a swap to the service, moving it instead of copying it
+	void Add(IRSwap&& swap);
+
 	// Q3.2 Get all Swaps with the specified fixed leg day count convention
 	vector<IRSwap> GetSwaps(DayCountConvention _fixedLegDayCountConvention);
 
@@ -63,167 +113,448 @@ public:
 	// Q3.6 Get all Swaps with a term in years less than the specified value
 	vector<IRSwap> GetSwapsLessThan(int _termYears);
 
+	// Get all Swaps with a term in years between the specified values; each bound is included or excluded as specified
+	vector<IRSwap> GetSwapsWithTermBetween(int _lowTermYears, int _highTermYears, bool _lowInclusive = true, bool _highInclusive = true);
+
+	// Get the Swaps in term buckets between increasing terms in years, e.g. 2, 5, 10, 30; see RangeIndex::Buckets
+	vector<vector<IRSwap> > GetSwapsByTermBuckets(const vector<int>& _bounds);
+
+	// Get all Swaps terminating between the specified dates; each bound is included or excluded as specified
+	vector<IRSwap> GetSwapsTerminatingBetween(date _low, date _high, bool _lowInclusive = true, bool _highInclusive = true);
+
+	// View all Swaps with the specified fixed leg day count convention, fixed leg payment frequency, floating index,
+	// swap type or swap leg type
+	ProductView<IRSwap> ViewSwaps(DayCountConvention _fixedLegDayCountConvention) const;
+	ProductView<IRSwap> ViewSwaps(PaymentFrequency _fixedLegPaymentFrequency) const;
+	ProductView<IRSwap> ViewSwaps(FloatingIndex _floatingIndex) const;
+	ProductView<IRSwap> ViewSwaps(SwapType _swapType) const;
+	ProductView<IRSwap> ViewSwaps(SwapLegType _swapLegType) const;
+
+	// View all Swaps with a term in years greater than, less than or between the specified values, in term order
+	ProductView<IRSwap> ViewSwapsGreaterThan(int _termYears) const;
+	ProductView<IRSwap> ViewSwapsLessThan(int _termYears) const;
+	ProductView<IRSwap> ViewSwapsWithTermBetween(int _lowTermYears, int _highTermYears, bool _lowInclusive = true, bool _highInclusive = true) const;
+
+	// View all Swaps terminating between the specified dates, in termination date order
+	ProductView<IRSwap> ViewSwapsTerminatingBetween(date _low, date _high, bool _lowInclusive = true, bool _highInclusive = true) const;
+
 	// Q3.7 Get all Swaps with the specified swap type
 	vector<IRSwap> GetSwaps(SwapType _swapType);
 
 	// Q3.8 Get all Swaps with the specified swap leg type
 	vector<IRSwap> GetSwaps(SwapLegType _swapLegType);
 
-private:
-	map<string, IRSwap> swapMap; // cache of IR Swap products
+	// Get all Swaps matching the filter, in the order they were added, by scanning the columnar store
+	vector<const IRSwap*> ScanSwaps(const SwapFilter& _filter) const;
+
+	// Get the number of Swaps matching the filter, by scanning the columnar store
+	size_t CountSwaps(const SwapFilter& _filter) const;
+
+	// Start a multi-predicate query over all swaps, e.g.
+	// Query().WithCurrency(USD).WithFloatingIndex(LIBOR).WithSwapType(SPOT).WithTermGreaterThan(5).Results()
+	SwapQuery Query() const;
 
 };
 
-BondProductService::BondProductService()
+BondProductService::BondProductService() :
+	ProductService("bond")
 {
-	bondMap = map<string, Bond>();
 }
 
-Bond& BondProductService::GetData(string productId)
+void BondProductService::Add(Bond& bond)
 {
-	return bondMap[productId];
+	Insert(bond);
 }
 
-void BondProductService::Add(Bond& bond)
+void BondProductService::Add(Bond&& bond)
 {
-	bondMap.insert(pair<string, Bond>(bond.GetProductId(), bond));
+	Insert(move(bond));
 }
 
 // Q3.1 Get all Bonds with the specified ticker
 vector<Bond> BondProductService::GetBonds(string& _ticker)
 {
-	vector<Bond> return_vec;
-	for (map<string, Bond>::iterator it = bondMap.begin(); it != bondMap.end(); it++)
-	{
-		if ((it->second).GetTicker() == _ticker) { return_vec.push_back(it->second); }
-	}
-	return return_vec;
+	return ToVector(ViewBonds(_ticker));
 };
 
-IRSwapProductService::IRSwapProductService()
+const vector<const Bond*>& BondProductService::GetBondsByTicker(const string& _ticker) const
 {
-	swapMap = map<string, IRSwap>();
+	return Postings<&Bond::GetTicker>().Get(_ticker);
 }
 
-IRSwap& IRSwapProductService::GetData(string productId)
+size_t BondProductService::GetBondCount(const string& _ticker) const
+{
+	return Postings<&Bond::GetTicker>().Count(_ticker);
+}
+
+vector<pair<string, size_t> > BondProductService::GetBondCountsByTicker() const
+{
+	vector<pair<string, size_t> > counts;
+	counts.reserve(Postings<&Bond::GetTicker>().KeyCount());
+	Postings<&Bond::GetTicker>().ForEach([&counts](const string& _ticker, const vector<const Bond*>& _bonds) { counts.push_back(make_pair(_ticker, _bonds.size())); });
+	return counts;
+}
+
+vector<Bond> BondProductService::GetBondsMaturingBetween(date _low, date _high, bool _lowInclusive, bool _highInclusive)
+{
+	return ToVector(ViewBondsMaturingBetween(_low, _high, _lowInclusive, _highInclusive));
+}
+
+vector<vector<Bond> > BondProductService::GetBondsByMaturityBuckets(const vector<date>& _bounds)
+{
+	return ToVectors(Range<&Bond::GetMaturityDate>().Buckets(_bounds));
+}
+
+ProductView<Bond> BondProductService::ViewBonds(const string& _ticker) const
+{
+	return View<&Bond::GetTicker>(_ticker);
+}
+
+ProductView<Bond> BondProductService::ViewBondsMaturingBetween(date _low, date _high, bool _lowInclusive, bool _highInclusive) const
+{
+	return Range<&Bond::GetMaturityDate>().Range(_low, _lowInclusive, _high, _highInclusive);
+}
+
+IRSwapProductService::IRSwapProductService() :
+	ProductService("swap")
 {
-	return swapMap[productId];
 }
 
 void IRSwapProductService::Add(IRSwap& swap)
 {
-	swapMap.insert(pair<string, IRSwap>(swap.GetProductId(), swap));
+	Insert(swap);
+}
+
+void IRSwapProductService::Add(IRSwap&& swap)
+{
+	Insert(move(swap));
 }
 
 // Q3.2 Get all Swaps with the specified fixed leg day count convention
 vector<IRSwap> IRSwapProductService::GetSwaps(DayCountConvention _fixedLegDayCountConvention)
 {
-	vector<IRSwap> return_vec;
-	for (map<string, IRSwap>::iterator it = swapMap.begin(); it != swapMap.end(); it++)
-	{
-		if ((it->second).GetFixedLegDayCountConvention() == _fixedLegDayCountConvention) { return_vec.push_back(it->second); }
-	}
-	return return_vec;
+	return ToVector(ViewSwaps(_fixedLegDayCountConvention));
 };
 
 // Q3.3 Get all Swaps with the specified fixed leg payment frequency
 vector<IRSwap> IRSwapProductService::GetSwaps(PaymentFrequency _fixedLegPaymentFrequency)
 {
-	vector<IRSwap> return_vec;
-	for (map<string, IRSwap>::iterator it = swapMap.begin(); it != swapMap.end(); it++)
-	{
-		if ((it->second).GetFixedLegPaymentFrequency() == _fixedLegPaymentFrequency) { return_vec.push_back(it->second); }
-	}
-	return return_vec;
+	return ToVector(ViewSwaps(_fixedLegPaymentFrequency));
 };
 
 // Q3.4 Get all Swaps with the specified floating index
 vector<IRSwap> IRSwapProductService::GetSwaps(FloatingIndex _floatingIndex)
 {
-	vector<IRSwap> return_vec;
-	for (map<string, IRSwap>::iterator it = swapMap.begin(); it != swapMap.end(); it++)
-	{
-		if ((it->second).GetFloatingIndex() == _floatingIndex) { return_vec.push_back(it->second); }
-	}
-	return return_vec;
+	return ToVector(ViewSwaps(_floatingIndex));
 };
 
 // Q3.5 Get all Swaps with a term in years greater than the specified value
 vector<IRSwap> IRSwapProductService::GetSwapsGreaterThan(int _termYears)
 {
-	vector<IRSwap> return_vec;
-	for (map<string, IRSwap>::iterator it = swapMap.begin(); it != swapMap.end(); it++)
-	{
-		if ((it->second).GetTermYears() > _termYears) { return_vec.push_back(it->second); }
-	}
-	return return_vec;
+	return ToVector(ViewSwapsGreaterThan(_termYears));
 };
 
 // Q3.6 Get all Swaps with a term in years less than the specified value
 vector<IRSwap> IRSwapProductService::GetSwapsLessThan(int _termYears)
 {
-	vector<IRSwap> return_vec;
-	for (map<string, IRSwap>::iterator it = swapMap.begin(); it != swapMap.end(); it++)
-	{
-		if ((it->second).GetTermYears() < _termYears) { return_vec.push_back(it->second); }
-	}
-	return return_vec;
+	return ToVector(ViewSwapsLessThan(_termYears));
 };
 
+vector<IRSwap> IRSwapProductService::GetSwapsWithTermBetween(int _lowTermYears, int _highTermYears, bool _lowInclusive, bool _highInclusive)
+{
+	return ToVector(ViewSwapsWithTermBetween(_lowTermYears, _highTermYears, _lowInclusive, _highInclusive));
+}
+
+vector<vector<IRSwap> > IRSwapProductService::GetSwapsByTermBuckets(const vector<int>& _bounds)
+{
+	return ToVectors(Range<&IRSwap::GetTermYears>().Buckets(_bounds));
+}
+
+vector<IRSwap> IRSwapProductService::GetSwapsTerminatingBetween(date _low, date _high, bool _lowInclusive, bool _highInclusive)
+{
+	return ToVector(ViewSwapsTerminatingBetween(_low, _high, _lowInclusive, _highInclusive));
+}
+
 // Q3.7 Get all Swaps with the specified swap type
 vector<IRSwap> IRSwapProductService::GetSwaps(SwapType _swapType)
 {
-	vector<IRSwap> return_vec;
-	for (map<string, IRSwap>::iterator it = swapMap.begin(); it != swapMap.end(); it++)
-	{
-		if ((it->second).GetSwapType() == _swapType) { return_vec.push_back(it->second); }
-	}
-	return return_vec;
+	return ToVector(ViewSwaps(_swapType));
 };
 
 // Q3.8 Get all Swaps with the specified swap leg type
 vector<IRSwap> IRSwapProductService::GetSwaps(SwapLegType _swapLegType)
 {
-	vector<IRSwap> return_vec;
-	for (map<string, IRSwap>::iterator it = swapMap.begin(); it != swapMap.end(); it++)
-	{
-		if ((it->second).GetSwapLegType() == _swapLegType) { return_vec.push_back(it->second); }
-	}
+	return ToVector(ViewSwaps(_swapLegType));
+};
+
+vector<const IRSwap*> IRSwapProductService::ScanSwaps(const SwapFilter& _filter) const
+{
+	vector<const IRSwap*> return_vec;
+	Store<IRSwapColumns>().Scan(_filter, [this, &return_vec](size_t row) { return_vec.push_back(Ordinals()[row]); });
 	return return_vec;
+}
+
+size_t IRSwapProductService::CountSwaps(const SwapFilter& _filter) const
+{
+	return Store<IRSwapColumns>().Count(_filter);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwaps(DayCountConvention _fixedLegDayCountConvention) const
+{
+	return View<&IRSwap::GetFixedLegDayCountConvention>(_fixedLegDayCountConvention);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwaps(PaymentFrequency _fixedLegPaymentFrequency) const
+{
+	return View<&IRSwap::GetFixedLegPaymentFrequency>(_fixedLegPaymentFrequency);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwaps(FloatingIndex _floatingIndex) const
+{
+	return View<&IRSwap::GetFloatingIndex>(_floatingIndex);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwaps(SwapType _swapType) const
+{
+	return View<&IRSwap::GetSwapType>(_swapType);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwaps(SwapLegType _swapLegType) const
+{
+	return View<&IRSwap::GetSwapLegType>(_swapLegType);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwapsGreaterThan(int _termYears) const
+{
+	return Range<&IRSwap::GetTermYears>().Above(_termYears, false);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwapsLessThan(int _termYears) const
+{
+	return Range<&IRSwap::GetTermYears>().Below(_termYears, false);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwapsWithTermBetween(int _lowTermYears, int _highTermYears, bool _lowInclusive, bool _highInclusive) const
+{
+	return Range<&IRSwap::GetTermYears>().Range(_lowTermYears, _lowInclusive, _highTermYears, _highInclusive);
+}
+
+ProductView<IRSwap> IRSwapProductService::ViewSwapsTerminatingBetween(date _low, date _high, bool _lowInclusive, bool _highInclusive) const
+{
+	return Range<&IRSwap::GetTerminationDate>().Range(_low, _lowInclusive, _high, _highInclusive);
+}
+
+/**
+ * Fluent multi-predicate query over the bonds of a BondProductService.
+ * Each predicate costs one bitmap operation over the service's bitmap indexes; see ProductQuery and IndexedQuery.
+ * A query holds pointers into the service, so it must not outlive it or be used across later Adds.
+ */
+class BondQuery : public IndexedQuery<BondProductService, BondQuery>
+{
+public:
+	// ctor over all bonds of the service
+	explicit BondQuery(const BondProductService& _service);
+
+	// Keep the bonds with the specified ticker
+	BondQuery& WithTicker(const string& _ticker);
+
+	// Keep the bonds with the specified id type
+	BondQuery& WithBondIdType(BondIdType _bondIdType);
+
 };
 
+BondQuery::BondQuery(const BondProductService& _service) :
+	IndexedQuery<BondProductService, BondQuery>(_service)
+{
+}
+
+BondQuery& BondQuery::WithTicker(const string& _ticker)
+{
+	return Where<&Bond::GetTicker>(_ticker);
+}
+
+BondQuery& BondQuery::WithBondIdType(BondIdType _bondIdType)
+{
+	return Where<&Bond::GetBondIdType>(_bondIdType);
+}
+
+BondQuery BondProductService::Query() const
+{
+	return BondQuery(*this);
+}
+
+/**
+ * Fluent multi-predicate query over the swaps of an IRSwapProductService, e.g. all USD 3M LIBOR spot outright swaps
+ * longer than 5 years that are not quarterly:
+ *   service.Query().WithCurrency(USD).WithFloatingIndex(LIBOR).WithFloatingIndexTenor(TENOR_3M).WithSwapType(SPOT)
+ *          .WithSwapLegType(OUTRIGHT).WithTermGreaterThan(5).Not().WithFixedLegPaymentFrequency(QUARTERLY).Results()
+ * Each predicate costs one bitmap operation over the service's bitmap indexes instead of a vector<IRSwap> copy per
+ * attribute; see ProductQuery and IndexedQuery.
+ * A query holds pointers into the service, so it must not outlive it or be used across later Adds.
+ */
+class SwapQuery : public IndexedQuery<IRSwapProductService, SwapQuery>
+{
+public:
+	// ctor over all swaps of the service
+	explicit SwapQuery(const IRSwapProductService& _service);
+
+	// Keep the swaps with the specified fixed leg day count convention
+	SwapQuery& WithFixedLegDayCountConvention(DayCountConvention _fixedLegDayCountConvention);
+
+	// Keep the swaps with the specified floating leg day count convention
+	SwapQuery& WithFloatingLegDayCountConvention(DayCountConvention _floatingLegDayCountConvention);
+
+	// Keep the swaps with the specified fixed leg payment frequency
+	SwapQuery& WithFixedLegPaymentFrequency(PaymentFrequency _fixedLegPaymentFrequency);
+
+	// Keep the swaps with the specified floating index
+	SwapQuery& WithFloatingIndex(FloatingIndex _floatingIndex);
+
+	// Keep the swaps with the specified floating index tenor
+	SwapQuery& WithFloatingIndexTenor(FloatingIndexTenor _floatingIndexTenor);
+
+	// Keep the swaps in the specified currency
+	SwapQuery& WithCurrency(Currency _currency);
+
+	// Keep the swaps with the specified swap type
+	SwapQuery& WithSwapType(SwapType _swapType);
+
+	// Keep the swaps with the specified swap leg type
+	SwapQuery& WithSwapLegType(SwapLegType _swapLegType);
+
+	// Keep the swaps with a term in years greater than the specified value
+	SwapQuery& WithTermGreaterThan(int _termYears);
+
+	// Keep the swaps with a term in years less than the specified value
+	SwapQuery& WithTermLessThan(int _termYears);
+
+	// Keep the swaps matching the filter, evaluated by a scan of the columnar store
+	SwapQuery& WithFilter(const SwapFilter& _filter);
+
+};
+
+SwapQuery::SwapQuery(const IRSwapProductService& _service) :
+	IndexedQuery<IRSwapProductService, SwapQuery>(_service)
+{
+}
+
+SwapQuery& SwapQuery::WithFixedLegDayCountConvention(DayCountConvention _fixedLegDayCountConvention)
+{
+	return Where<&IRSwap::GetFixedLegDayCountConvention>(_fixedLegDayCountConvention);
+}
+
+SwapQuery& SwapQuery::WithFloatingLegDayCountConvention(DayCountConvention _floatingLegDayCountConvention)
+{
+	return Where<&IRSwap::GetFloatingLegDayCountConvention>(_floatingLegDayCountConvention);
+}
+
+SwapQuery& SwapQuery::WithFixedLegPaymentFrequency(PaymentFrequency _fixedLegPaymentFrequency)
+{
+	return Where<&IRSwap::GetFixedLegPaymentFrequency>(_fixedLegPaymentFrequency);
+}
+
+SwapQuery& SwapQuery::WithFloatingIndex(FloatingIndex _floatingIndex)
+{
+	return Where<&IRSwap::GetFloatingIndex>(_floatingIndex);
+}
+
+SwapQuery& SwapQuery::WithFloatingIndexTenor(FloatingIndexTenor _floatingIndexTenor)
+{
+	return Where<&IRSwap::GetFloatingIndexTenor>(_floatingIndexTenor);
+}
+
+SwapQuery& SwapQuery::WithCurrency(Currency _currency)
+{
+	return Where<&IRSwap::GetCurrency>(_currency);
+}
+
+SwapQuery& SwapQuery::WithSwapType(SwapType _swapType)
+{
+	return Where<&IRSwap::GetSwapType>(_swapType);
+}
+
+SwapQuery& SwapQuery::WithSwapLegType(SwapLegType _swapLegType)
+{
+	return Where<&IRSwap::GetSwapLegType>(_swapLegType);
+}
+
+SwapQuery& SwapQuery::WithTermGreaterThan(int _termYears)
+{
+	return WhereAbove<&IRSwap::GetTermYears>(_termYears);
+}
+
+SwapQuery& SwapQuery::WithTermLessThan(int _termYears)
+{
+	return WhereBelow<&IRSwap::GetTermYears>(_termYears);
+}
+
+SwapQuery& SwapQuery::WithFilter(const SwapFilter& _filter)
+{
+	return Combine(service->Store<IRSwapColumns>().Select(_filter));
+}
+
+SwapQuery IRSwapProductService::Query() const
+{
+	return SwapQuery(*this);
+}
+
 /**
  * Future Product Service to own reference data over a set of future products.
- * Key is the productId string, value is a Future.
+ * Key is the productId string, value is a Future, held in a hash map by the ProductService base, which maintains the
+ * future type, exchange and maturity indexes; Query() combines predicates on type and exchange, e.g.
+ * Query().Where<&Future::GetFutureType>(RATE).Where<&Future::GetFutureExchange>(CME).Results()
  */
-class FutureProductService : public Service<string, Future>
+class FutureProductService : public ProductService<Future, IndexOn<&Future::GetFutureType>, IndexOn<&Future::GetFutureExchange>, RangeOn<&Future::GetMaturityDate> >
 {
 public:
 	// FutureProductService ctor
 	FutureProductService();
 
-	// Return the future data for a particular future product identifier
-	Future& GetData(string productId);
-
 	// Add a future to the service (convenience method)
 	void Add(Future& future);
 
-private:
-	map<string, Future> futureMap; // cache of future products
+	// Add a future to the service, moving it instead of copying it
+	void Add(Future&& future);
+
+	// Get all Futures maturing between the specified dates, in maturity order; each bound is included or excluded as specified
+	vector<Future> GetFuturesMaturingBetween(date _low, date _high, bool _lowInclusive = true, bool _highInclusive = true);
+
+	// Get the Futures in maturity buckets between increasing dates, see RangeIndex::Buckets
+	vector<vector<Future> > GetFuturesByMaturityBuckets(const vector<date>& _bounds);
+
+	// View all Futures maturing between the specified dates, in maturity order, without copying them
+	ProductView<Future> ViewFuturesMaturingBetween(date _low, date _high, bool _lowInclusive = true, bool _highInclusive = true) const;
 
 };
 
-FutureProductService::FutureProductService()
+FutureProductService::FutureProductService() :
+	ProductService("future")
 {
-	futureMap = map<string, Future>();
 }
 
-Future& FutureProductService::GetData(string productId)
+void FutureProductService::Add(Future& future)
 {
-	return futureMap[productId];
+	Insert(future);
 }
 
-void FutureProductService::Add(Future& future)
+void FutureProductService::Add(Future&& future)
 {
-	futureMap.insert(pair<string, Future>(future.GetProductId(), future));
-}
\ No newline at end of file
+	Insert(move(future));
+}
+
+vector<Future> FutureProductService::GetFuturesMaturingBetween(date _low, date _high, bool _lowInclusive, bool _highInclusive)
+{
+	return ToVector(ViewFuturesMaturingBetween(_low, _high, _lowInclusive, _highInclusive));
+}
+
+vector<vector<Future> > FutureProductService::GetFuturesByMaturityBuckets(const vector<date>& _bounds)
+{
+	return ToVectors(Range<&Future::GetMaturityDate>().Buckets(_bounds));
+}
+
+ProductView<Future> FutureProductService::ViewFuturesMaturingBetween(date _low, date _high, bool _lowInclusive, bool _highInclusive) const
+{
+	return Range<&Future::GetMaturityDate>().Range(_low, _lowInclusive, _high, _highInclusive);
+}
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * productview.hpp defines ProductView, a read-only view of query results that lets callers iterate the matching
+ * products without allocating or copying them
+ */
+
+#ifndef PRODUCTVIEW_HPP
+#define PRODUCTVIEW_HPP
+
+#include <cstddef>
+#include <iterator>
+
+using namespace std;
+
+/**
+ * View of products owned by a service, over an array of product pointers kept by one of its indexes.
+ * Iterating a view yields const references to the products themselves; nothing is allocated or copied.
+ * A view borrows the index storage, so it is invalidated by the next Add to the service.
+ * Uses product type T.
+ */
+template<typename T>
+class ProductView
+{
+public:
+	/**
+	 * Iterator over the products of a view, dereferencing the stored pointers.
+	 */
+	class const_iterator
+	{
+	public:
+		typedef random_access_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const T* pointer;
+		typedef const T& reference;
+
+		const_iterator() : position(nullptr) {}
+		explicit const_iterator(const T* const* _position) : position(_position) {}
+
+		reference operator*() const { return **position; }
+		pointer operator->() const { return *position; }
+		reference operator[](difference_type n) const { return *position[n]; }
+		const_iterator& operator++() { ++position; return *this; }
+		const_iterator operator++(int) { const_iterator old(*this); ++position; return old; }
+		const_iterator& operator--() { --position; return *this; }
+		const_iterator operator--(int) { const_iterator old(*this); --position; return old; }
+		const_iterator& operator+=(difference_type n) { position += n; return *this; }
+		const_iterator& operator-=(difference_type n) { position -= n; return *this; }
+		const_iterator operator+(difference_type n) const { return const_iterator(position + n); }
+		const_iterator operator-(difference_type n) const { return const_iterator(position - n); }
+		difference_type operator-(const const_iterator& other) const { return position - other.position; }
+		bool operator==(const const_iterator& other) const { return position == other.position; }
+		bool operator!=(const const_iterator& other) const { return position != other.position; }
+		bool operator<(const const_iterator& other) const { return position < other.position; }
+
+	private:
+		const T* const* position;
+
+	};
+
+	// ctor for an empty view
+	ProductView();
+
+	// ctor over the product pointers [_first, _last)
+	ProductView(const T* const* _first, const T* const* _last);
+
+	// Iterators over the products
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	// Return the number of products in the view
+	size_t size() const;
+
+	// Return whether the view has no products
+	bool empty() const;
+
+	// Return the product at the given position
+	const T& operator[](size_t _index) const;
+
+private:
+	const T* const* first;
+	const T* const* last;
+
+};
+
+template<typename T>
+ProductView<T>::ProductView() :
+	first(nullptr), last(nullptr)
+{
+}
+
+template<typename T>
+ProductView<T>::ProductView(const T* const* _first, const T* const* _last) :
+	first(_first), last(_last)
+{
+}
+
+template<typename T>
+typename ProductView<T>::const_iterator ProductView<T>::begin() const
+{
+	return const_iterator(first);
+}
+
+template<typename T>
+typename ProductView<T>::const_iterator ProductView<T>::end() const
+{
+	return const_iterator(last);
+}
+
+template<typename T>
+size_t ProductView<T>::size() const
+{
+	return static_cast<size_t>(last - first);
+}
+
+template<typename T>
+bool ProductView<T>::empty() const
+{
+	return first == last;
+}
+
+template<typename T>
+const T& ProductView<T>::operator[](size_t _index) const
+{
+	return *first[_index];
+}
+
+#endif
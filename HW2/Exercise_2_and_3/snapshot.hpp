@@ -0,0 +1,448 @@
+/**
+ * snapshot.hpp defines versioned binary snapshots of the ProductServices: files holding the flat products of a service
+ * in ordinal order, a hash index by productId and the secondary indexes of the service, written atomically and
+ * reopened by mapping them, with no parsing
+ *
+ * Layout, in native byte order, each section 8-byte aligned:
+ *   SnapshotHeader
+ *   records: FlatBond, FlatIRSwap or FlatFuture [recordCount], the products in the order they were added
+ *   slots: uint32_t [slotCount], open addressing table by productId hash of ordinal + 1 (0 for an empty slot)
+ *   index sections [indexCount], one per index declared by the service, written by ProductService::SaveIndexes: the
+ *   bitmaps of each IndexOn (whose posting lists hold the same ordinals), the ordinals of each RangeOn in sorted order,
+ *   and the columns of a StoreIn such as IRSwapColumns
+ *
+ * ProductSnapshot serves the records and productId lookups in place, in milliseconds for a million products.
+ * RestoreSnapshot into an empty service rebuilds only the product hash map from the records and copies the index
+ * sections into the indexes as they are: no posting list, bitmap or swap column is rebuilt product by product and no
+ * range index is sorted. Restoring a million swaps takes 0.8 to 0.9 s on a single core, against 1.3 s when the
+ * indexes were rebuilt from the products. About 0.55 s of it is inserting into the product hash map, which no file
+ * layout can save, since the service stores rich products by productId.
+ */
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "flatproducts.hpp"
+#include "indexsection.hpp"
+#include "mappedfile.hpp"
+#include "productservice.hpp"
+
+using namespace std;
+
+// First bytes of every snapshot file
+const char SNAPSHOT_MAGIC[8] = { 'P', 'R', 'O', 'D', 'S', 'N', 'A', 'P' };
+
+// Format version written by SaveSnapshot; files of another version are rejected
+const uint32_t SNAPSHOT_VERSION = 2;
+
+// Written as a native integer, so a file written on a machine of the other byte order is rejected
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// Kind of flat record a snapshot holds
+enum SnapshotRecordType { BOND_RECORDS = 1, IRSWAP_RECORDS = 2, FUTURE_RECORDS = 3 };
+
+// Most index sections a snapshot can hold, i.e. most indexes a service can declare to be saved
+const size_t SNAPSHOT_MAX_INDEXES = 16;
+
+/**
+ * Position, size and checksum of an index section.
+ */
+struct SnapshotSection
+{
+	uint64_t offset; // in bytes from the start of the file
+	uint64_t size;
+	uint64_t checksum;
+};
+
+/**
+ * Header of a snapshot file: 472 bytes.
+ * The checksums cover the records, the slots, each index section and the header itself (with headerChecksum taken as 0).
+ */
+struct SnapshotHeader
+{
+	char magic[8]; // SNAPSHOT_MAGIC
+	uint32_t version; // SNAPSHOT_VERSION
+	uint32_t byteOrder; // SNAPSHOT_BYTE_ORDER
+	uint32_t recordType; // SnapshotRecordType
+	uint32_t recordSize; // sizeof the flat record
+	uint64_t recordCount;
+	uint64_t slotCount; // a power of two, at least twice recordCount
+	uint64_t recordsOffset; // in bytes from the start of the file
+	uint64_t slotsOffset;
+	uint64_t recordsChecksum;
+	uint64_t slotsChecksum;
+	uint64_t indexCount; // number of index sections in use
+	SnapshotSection indexes[SNAPSHOT_MAX_INDEXES];
+	uint64_t headerChecksum;
+};
+
+static_assert(sizeof(SnapshotHeader) == 472, "The snapshot header layout is shared between builds");
+
+/**
+ * Record type of a flat product.
+ */
+template<typename F>
+struct SnapshotRecord;
+
+template<>
+struct SnapshotRecord<FlatBond>
+{
+	static const SnapshotRecordType type = BOND_RECORDS;
+};
+
+template<>
+struct SnapshotRecord<FlatIRSwap>
+{
+	static const SnapshotRecordType type = IRSWAP_RECORDS;
+};
+
+template<>
+struct SnapshotRecord<FlatFuture>
+{
+	static const SnapshotRecordType type = FUTURE_RECORDS;
+};
+
+// Checksum of a block of bytes, to detect truncated or corrupted files (not tampering). Four independent lanes of
+// 8-byte words keep it close to memory speed.
+inline uint64_t SnapshotChecksum(const void* _data, size_t _size)
+{
+	const uint64_t prime = 0x9E3779B97F4A7C15ull;
+	const unsigned char* bytes = static_cast<const unsigned char*>(_data);
+	uint64_t lanes[4] = { 1, 2, 3, 4 };
+	size_t position = 0;
+	for (; position + 32 <= _size; position += 32)
+	{
+		for (int lane = 0; lane < 4; lane++)
+		{
+			uint64_t word;
+			memcpy(&word, bytes + position + 8 * lane, 8);
+			lanes[lane] = (lanes[lane] ^ word) * prime;
+			lanes[lane] ^= lanes[lane] >> 29;
+		}
+	}
+	uint64_t checksum = _size;
+	for (; position < _size; position++) { checksum = (checksum ^ bytes[position]) * prime; }
+	for (int lane = 0; lane < 4; lane++) { checksum = (checksum ^ lanes[lane]) * prime; checksum ^= checksum >> 32; }
+	return checksum;
+}
+
+// Hash of a productId for the slot table (FNV-1a)
+inline uint64_t SnapshotIdHash(string_view _productId)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (size_t i = 0; i < _productId.size(); i++) { hash = (hash ^ static_cast<unsigned char>(_productId[i])) * 0x100000001B3ull; }
+	return hash;
+}
+
+// Whether the NUL-padded field holds exactly the productId
+template<size_t N>
+bool SnapshotIdEquals(const char (&_field)[N], string_view _productId)
+{
+	return _productId.size() < N && memcmp(_field, _productId.data(), _productId.size()) == 0 && _field[_productId.size()] == '\0';
+}
+
+/**
+ * A snapshot file opened in place: the flat records, the productId index and the index sections are read straight from
+ * the mapped file, so opening costs one validation pass (the checksums) whatever the number of products, and nothing is
+ * parsed or copied.
+ * Uses flat record type F (FlatBond, FlatIRSwap or FlatFuture).
+ */
+template<typename F>
+class ProductSnapshot
+{
+public:
+	// Open and validate the snapshot; throws runtime_error if the file cannot be read, is not a snapshot of F records
+	// of this version, or fails its checksums (checked unless _verify is false)
+	explicit ProductSnapshot(const string& _path, bool _verify = true);
+
+	// Return the number of products
+	size_t Size() const;
+
+	// Return the product of the given ordinal
+	const F& operator[](size_t _ordinal) const;
+
+	// Return the products in ordinal order
+	const F* Records() const;
+
+	// Return the product with the product identifier, or nullptr if there is none
+	const F* Find(string_view _productId) const;
+
+	// Return the number of index sections
+	size_t IndexCount() const;
+
+	// Return the bytes of an index section, in place
+	string_view IndexSection(size_t _index) const;
+
+private:
+	MappedFile file;
+	const SnapshotHeader* header;
+	const F* records;
+	const uint32_t* slots;
+
+};
+
+template<typename F>
+ProductSnapshot<F>::ProductSnapshot(const string& _path, bool _verify) :
+	file(_path), header(nullptr), records(nullptr), slots(nullptr)
+{
+	const string_view contents = file.Contents();
+	if (contents.size() < sizeof(SnapshotHeader)) { throw runtime_error(_path + " is not a snapshot: too short"); }
+	header = reinterpret_cast<const SnapshotHeader*>(contents.data());
+	if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) { throw runtime_error(_path + " is not a snapshot"); }
+	if (header->byteOrder != SNAPSHOT_BYTE_ORDER) { throw runtime_error(_path + " was written with another byte order"); }
+	if (header->version != SNAPSHOT_VERSION) { throw runtime_error(_path + " has unsupported snapshot version " + to_string(header->version)); }
+	if (header->recordType != SnapshotRecord<F>::type || header->recordSize != sizeof(F)) { throw runtime_error(_path + " holds another kind of product"); }
+	// Every bound is checked by subtracting from the file size, so that no offset or count in a damaged header can
+	// overflow past it, even when the checksums are not verified
+	const uint64_t size = contents.size();
+	if (header->recordCount > size / sizeof(F) || header->slotCount > size / sizeof(uint32_t)
+		|| header->slotCount == 0 || (header->slotCount & (header->slotCount - 1)) != 0 || header->slotCount / 2 < header->recordCount
+		|| header->recordsOffset % 8 != 0 || header->slotsOffset % 8 != 0
+		|| header->recordsOffset < sizeof(SnapshotHeader) || header->recordsOffset > size || header->recordCount * sizeof(F) > size - header->recordsOffset
+		|| header->slotsOffset < header->recordsOffset + header->recordCount * sizeof(F) || header->slotsOffset > size
+		|| header->slotCount * sizeof(uint32_t) > size - header->slotsOffset || header->indexCount > SNAPSHOT_MAX_INDEXES)
+	{
+		throw runtime_error(_path + " is truncated or has an invalid layout");
+	}
+	for (uint64_t i = 0; i < header->indexCount; i++)
+	{
+		const SnapshotSection& section = header->indexes[i];
+		if (section.offset % 8 != 0 || section.offset < sizeof(SnapshotHeader) || section.offset > size || section.size > size - section.offset)
+		{
+			throw runtime_error(_path + " is truncated or has an invalid layout");
+		}
+	}
+	const uint64_t recordBytes = header->recordCount * sizeof(F);
+	const uint64_t slotBytes = header->slotCount * sizeof(uint32_t);
+	records = reinterpret_cast<const F*>(contents.data() + header->recordsOffset);
+	slots = reinterpret_cast<const uint32_t*>(contents.data() + header->slotsOffset);
+
+	if (_verify)
+	{
+		SnapshotHeader copy = *header;
+		copy.headerChecksum = 0;
+		if (SnapshotChecksum(&copy, sizeof(copy)) != header->headerChecksum || SnapshotChecksum(records, recordBytes) != header->recordsChecksum
+			|| SnapshotChecksum(slots, slotBytes) != header->slotsChecksum)
+		{
+			throw runtime_error(_path + " fails its checksum");
+		}
+		for (uint64_t i = 0; i < header->indexCount; i++)
+		{
+			if (SnapshotChecksum(contents.data() + header->indexes[i].offset, header->indexes[i].size) != header->indexes[i].checksum)
+			{
+				throw runtime_error(_path + " fails its checksum");
+			}
+		}
+	}
+}
+
+template<typename F>
+size_t ProductSnapshot<F>::Size() const
+{
+	return header->recordCount;
+}
+
+template<typename F>
+const F& ProductSnapshot<F>::operator[](size_t _ordinal) const
+{
+	return records[_ordinal];
+}
+
+template<typename F>
+const F* ProductSnapshot<F>::Records() const
+{
+	return records;
+}
+
+template<typename F>
+const F* ProductSnapshot<F>::Find(string_view _productId) const
+{
+	// At most slotCount probes, so that a damaged table with no empty slot cannot loop forever
+	const uint64_t mask = header->slotCount - 1;
+	uint64_t slot = SnapshotIdHash(_productId) & mask;
+	for (uint64_t probe = 0; probe < header->slotCount && slots[slot] != 0; probe++, slot = (slot + 1) & mask)
+	{
+		const uint32_t ordinal = slots[slot] - 1;
+		if (ordinal < header->recordCount && SnapshotIdEquals(records[ordinal].productId, _productId)) { return &records[ordinal]; }
+	}
+	return nullptr;
+}
+
+template<typename F>
+size_t ProductSnapshot<F>::IndexCount() const
+{
+	return header->indexCount;
+}
+
+template<typename F>
+string_view ProductSnapshot<F>::IndexSection(size_t _index) const
+{
+	return file.Contents().substr(header->indexes[_index].offset, header->indexes[_index].size);
+}
+
+// Write a snapshot of the products and indexes of a service, in ordinal order, atomically: the file is written next to the target,
+// flushed to disk and renamed over it, so readers see either the previous snapshot or the complete new one. Throws
+// runtime_error if the file cannot be written, and length_error naming the productId and ordinal of the first product
+// that does not fit its flat record (see flatproducts.hpp for the field widths), in which case no file is written.
+template<typename F, typename S>
+void SaveProductSnapshot(const S& _service, const string& _path)
+{
+	static_assert(S::IndexCount <= SNAPSHOT_MAX_INDEXES, "The service declares more indexes than a snapshot holds");
+	const vector<const typename S::ProductType*>& products = _service.Ordinals();
+	vector<F> records;
+	records.reserve(products.size());
+	for (size_t ordinal = 0; ordinal < products.size(); ordinal++)
+	{
+		try
+		{
+			records.push_back(ToFlat(*products[ordinal]));
+		}
+		catch (const length_error& error)
+		{
+			throw length_error("Cannot snapshot product " + products[ordinal]->GetProductId() + " (ordinal " + to_string(ordinal) + "): " + error.what());
+		}
+	}
+
+	uint64_t slotCount = 16;
+	while (slotCount < 2 * records.size()) { slotCount *= 2; }
+	vector<uint32_t> slots(slotCount, 0);
+	for (size_t ordinal = 0; ordinal < records.size(); ordinal++)
+	{
+		uint64_t slot = SnapshotIdHash(FromFixedString(records[ordinal].productId)) & (slotCount - 1);
+		while (slots[slot] != 0) { slot = (slot + 1) & (slotCount - 1); }
+		slots[slot] = static_cast<uint32_t>(ordinal + 1);
+	}
+
+	SnapshotHeader header = {};
+	memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	header.version = SNAPSHOT_VERSION;
+	header.byteOrder = SNAPSHOT_BYTE_ORDER;
+	header.recordType = SnapshotRecord<F>::type;
+	header.recordSize = sizeof(F);
+	header.recordCount = records.size();
+	header.slotCount = slotCount;
+	header.recordsOffset = sizeof(SnapshotHeader);
+	const uint64_t recordBytes = records.size() * sizeof(F);
+	const uint64_t recordPadding = (8 - recordBytes % 8) % 8;
+	header.slotsOffset = header.recordsOffset + recordBytes + recordPadding;
+	header.recordsChecksum = SnapshotChecksum(records.data(), recordBytes);
+	header.slotsChecksum = SnapshotChecksum(slots.data(), slots.size() * sizeof(uint32_t));
+
+	// Section sizes are multiples of 8, so each section starts aligned right after the previous one
+	const vector<SectionWriter> sections = _service.SaveIndexes();
+	uint64_t sectionOffset = header.slotsOffset + slots.size() * sizeof(uint32_t);
+	header.indexCount = sections.size();
+	for (size_t i = 0; i < sections.size(); i++)
+	{
+		const vector<char>& bytes = sections[i].Bytes();
+		header.indexes[i].offset = sectionOffset;
+		header.indexes[i].size = bytes.size();
+		header.indexes[i].checksum = SnapshotChecksum(bytes.data(), bytes.size());
+		sectionOffset += bytes.size();
+	}
+	header.headerChecksum = SnapshotChecksum(&header, sizeof(header));
+
+	const string temporaryPath = _path + ".tmp";
+	FILE* file = fopen(temporaryPath.c_str(), "wb");
+	if (file == nullptr) { throw runtime_error("Cannot create " + temporaryPath + ": " + strerror(errno)); }
+	const char padding[8] = {};
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1
+		&& (recordBytes == 0 || fwrite(records.data(), recordBytes, 1, file) == 1)
+		&& (recordPadding == 0 || fwrite(padding, recordPadding, 1, file) == 1)
+		&& fwrite(slots.data(), slots.size() * sizeof(uint32_t), 1, file) == 1;
+	for (size_t i = 0; i < sections.size(); i++)
+	{
+		const vector<char>& bytes = sections[i].Bytes();
+		written = written && (bytes.empty() || fwrite(bytes.data(), bytes.size(), 1, file) == 1);
+	}
+	written = written && fflush(file) == 0;
+#if defined(MAPPEDFILE_MMAP)
+	written = written && fsync(fileno(file)) == 0;
+#endif
+	written = fclose(file) == 0 && written;
+	if (!written)
+	{
+		remove(temporaryPath.c_str());
+		throw runtime_error("Cannot write " + temporaryPath);
+	}
+#if !defined(MAPPEDFILE_MMAP)
+	remove(_path.c_str()); // rename does not replace an existing file there
+#endif
+	if (rename(temporaryPath.c_str(), _path.c_str()) != 0)
+	{
+		remove(temporaryPath.c_str());
+		throw runtime_error("Cannot rename " + temporaryPath + " to " + _path);
+	}
+}
+
+// Add the products of a snapshot to a service, in ordinal order, so that ordinals, queries and the secondary indexes
+// match the service that was saved, then finalize the service so that it can be queried from several threads; returns
+// the number of products added. An empty service loads the saved indexes as they are; a service that already holds
+// products indexes the added ones one by one, as any other Add does.
+template<typename F, typename S>
+size_t RestoreProductSnapshot(const string& _path, S& _service, bool _verify)
+{
+	ProductSnapshot<F> snapshot(_path, _verify);
+	if (_service.Size() == 0)
+	{
+		vector<SectionReader> sections;
+		for (size_t i = 0; i < snapshot.IndexCount(); i++) { sections.push_back(SectionReader(snapshot.IndexSection(i))); }
+		_service.Restore(snapshot.Size(), [&snapshot](size_t _ordinal) { return FromFlat(snapshot[_ordinal]); }, sections);
+		_service.Finalize();
+		return _service.Size();
+	}
+	const size_t before = _service.Size();
+	_service.Reserve(before + snapshot.Size());
+	for (size_t ordinal = 0; ordinal < snapshot.Size(); ordinal++)
+	{
+		_service.Add(FromFlat(snapshot[ordinal]));
+	}
+	_service.Finalize();
+	return _service.Size() - before;
+}
+
+// Save a Bond, IRSwap or Future service to a snapshot file. Every product must fit its flat record: bond and future
+// productIds of at most 15 characters, swap productIds of at most 23 and bond tickers of at most 7; otherwise
+// length_error names the first product that does not fit and nothing is written
+inline void SaveSnapshot(const BondProductService& _service, const string& _path)
+{
+	SaveProductSnapshot<FlatBond>(_service, _path);
+}
+
+inline void SaveSnapshot(const IRSwapProductService& _service, const string& _path)
+{
+	SaveProductSnapshot<FlatIRSwap>(_service, _path);
+}
+
+inline void SaveSnapshot(const FutureProductService& _service, const string& _path)
+{
+	SaveProductSnapshot<FlatFuture>(_service, _path);
+}
+
+// Restore a Bond, IRSwap or Future snapshot file into a service; throws runtime_error if the file is not a valid
+// snapshot of that kind of product or its index sections do not match the indexes of the service, in which case
+// nothing is added
+inline size_t RestoreSnapshot(const string& _path, BondProductService& _service, bool _verify = true)
+{
+	return RestoreProductSnapshot<FlatBond>(_path, _service, _verify);
+}
+
+inline size_t RestoreSnapshot(const string& _path, IRSwapProductService& _service, bool _verify = true)
+{
+	return RestoreProductSnapshot<FlatIRSwap>(_path, _service, _verify);
+}
+
+inline size_t RestoreSnapshot(const string& _path, FutureProductService& _service, bool _verify = true)
+{
+	return RestoreProductSnapshot<FlatFuture>(_path, _service, _verify);
+}
+
+#endif
@@ -0,0 +1,343 @@
+/**
+ * swapcolumns.hpp defines a columnar (structure of arrays) copy of the IRSwap attributes, so that filters over the
+ * whole swap universe scan packed arrays instead of one scattered IRSwap object per swap
+ */
+
+#ifndef SWAPCOLUMNS_HPP
+#define SWAPCOLUMNS_HPP
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#include "products.hpp"
+#include "flatproducts.hpp"
+#include "bitmap.hpp"
+#include "indexsection.hpp"
+
+using namespace std;
+
+/**
+ * Conditions of a columnar swap scan. An enum field restricts the swaps to one value of the attribute (ANY leaves it
+ * free); the range fields are inclusive bounds, with dates given as day serials (see ToDaySerial).
+ */
+struct SwapFilter
+{
+	static const int16_t ANY = -1;
+
+	int16_t fixedLegDayCountConvention = ANY;
+	int16_t floatingLegDayCountConvention = ANY;
+	int16_t fixedLegPaymentFrequency = ANY;
+	int16_t floatingIndex = ANY;
+	int16_t floatingIndexTenor = ANY;
+	int16_t currency = ANY;
+	int16_t swapType = ANY;
+	int16_t swapLegType = ANY;
+	int32_t minTermYears = numeric_limits<int32_t>::min();
+	int32_t maxTermYears = numeric_limits<int32_t>::max();
+	int32_t minEffectiveDate = numeric_limits<int32_t>::min();
+	int32_t maxEffectiveDate = numeric_limits<int32_t>::max();
+	int32_t minTerminationDate = numeric_limits<int32_t>::min();
+	int32_t maxTerminationDate = numeric_limits<int32_t>::max();
+};
+
+/**
+ * IRSwap attributes stored column by column: one packed uint8_t array per enum and one int32_t array per term and
+ * date, with row i describing the i-th swap added.
+ * Scan evaluates a SwapFilter 32 rows at a time: with AVX2 an enum condition is one 32-byte compare and an int range
+ * four 8-lane compares per block; SSE2 (any x86-64) takes twice as many 16-byte compares, and other targets build the
+ * same 32-bit block mask with a scalar loop. Only the columns a filter constrains are read, so a scan streams a few
+ * bytes per swap and is bound by memory bandwidth.
+ */
+class IRSwapColumns
+{
+public:
+	// Append a row for the swap
+	void Add(const IRSwap& swap);
+
+	// Make room for the given number of rows without reallocating
+	void Reserve(size_t rows);
+
+	// Return the number of rows
+	size_t Size() const;
+
+	// Write every column to a section
+	void Save(SectionWriter& section) const;
+
+	// Replace the columns with ones written by Save, copying each array as it is; throws runtime_error unless every
+	// column holds the given number of rows
+	void Load(SectionReader& section, size_t rows);
+
+	// Call f(row) for every row matching the filter, in increasing row order
+	template<typename F>
+	void Scan(const SwapFilter& filter, F f) const;
+
+	// Return the number of rows matching the filter
+	size_t Count(const SwapFilter& filter) const;
+
+	// Return the rows matching the filter as a bitmap, e.g. to combine with the bitmap indexes
+	Bitmap Select(const SwapFilter& filter) const;
+
+private:
+	static const size_t BlockRows = 32;
+
+	// An enum column constrained by a filter
+	struct ByteCondition
+	{
+		const uint8_t* column;
+		uint8_t value;
+	};
+
+	// An int column constrained by a filter, with inclusive bounds
+	struct RangeCondition
+	{
+		const int32_t* column;
+		int32_t low;
+		int32_t high;
+	};
+
+	// The conditions of a filter that constrain something
+	struct Conditions
+	{
+		vector<ByteCondition> bytes;
+		vector<RangeCondition> ranges;
+	};
+
+	Conditions Compile(const SwapFilter& filter) const;
+
+	// Bit i of the result is set if row first + i matches, for a full block of BlockRows rows
+	static uint32_t BlockMask(const Conditions& conditions, size_t first);
+
+	// Whether a single row matches
+	static bool RowMatches(const Conditions& conditions, size_t row);
+
+	// Read one column written by Save, which must hold the given number of rows
+	template<typename C>
+	static void LoadColumn(SectionReader& section, size_t rows, vector<C>& column);
+
+	vector<uint8_t> fixedLegDayCountConventions;
+	vector<uint8_t> floatingLegDayCountConventions;
+	vector<uint8_t> fixedLegPaymentFrequencies;
+	vector<uint8_t> floatingIndexes;
+	vector<uint8_t> floatingIndexTenors;
+	vector<uint8_t> currencies;
+	vector<uint8_t> swapTypes;
+	vector<uint8_t> swapLegTypes;
+	vector<int32_t> termYears;
+	vector<int32_t> effectiveDates; // day serials
+	vector<int32_t> terminationDates; // day serials
+
+};
+
+void IRSwapColumns::Add(const IRSwap& swap)
+{
+	fixedLegDayCountConventions.push_back(static_cast<uint8_t>(swap.GetFixedLegDayCountConvention()));
+	floatingLegDayCountConventions.push_back(static_cast<uint8_t>(swap.GetFloatingLegDayCountConvention()));
+	fixedLegPaymentFrequencies.push_back(static_cast<uint8_t>(swap.GetFixedLegPaymentFrequency()));
+	floatingIndexes.push_back(static_cast<uint8_t>(swap.GetFloatingIndex()));
+	floatingIndexTenors.push_back(static_cast<uint8_t>(swap.GetFloatingIndexTenor()));
+	currencies.push_back(static_cast<uint8_t>(swap.GetCurrency()));
+	swapTypes.push_back(static_cast<uint8_t>(swap.GetSwapType()));
+	swapLegTypes.push_back(static_cast<uint8_t>(swap.GetSwapLegType()));
+	termYears.push_back(swap.GetTermYears());
+	effectiveDates.push_back(ToDaySerial(swap.GetEffectiveDate()));
+	terminationDates.push_back(ToDaySerial(swap.GetTerminationDate()));
+}
+
+void IRSwapColumns::Reserve(size_t rows)
+{
+	fixedLegDayCountConventions.reserve(rows);
+	floatingLegDayCountConventions.reserve(rows);
+	fixedLegPaymentFrequencies.reserve(rows);
+	floatingIndexes.reserve(rows);
+	floatingIndexTenors.reserve(rows);
+	currencies.reserve(rows);
+	swapTypes.reserve(rows);
+	swapLegTypes.reserve(rows);
+	termYears.reserve(rows);
+	effectiveDates.reserve(rows);
+	terminationDates.reserve(rows);
+}
+
+size_t IRSwapColumns::Size() const
+{
+	return swapTypes.size();
+}
+
+void IRSwapColumns::Save(SectionWriter& section) const
+{
+	const vector<uint8_t>* enums[] = { &fixedLegDayCountConventions, &floatingLegDayCountConventions, &fixedLegPaymentFrequencies,
+		&floatingIndexes, &floatingIndexTenors, &currencies, &swapTypes, &swapLegTypes };
+	const vector<int32_t>* ints[] = { &termYears, &effectiveDates, &terminationDates };
+	for (size_t i = 0; i < 8; i++) { section.Array(enums[i]->data(), enums[i]->size()); }
+	for (size_t i = 0; i < 3; i++) { section.Array(ints[i]->data(), ints[i]->size()); }
+}
+
+void IRSwapColumns::Load(SectionReader& section, size_t rows)
+{
+	IRSwapColumns loaded;
+	vector<uint8_t>* enums[] = { &loaded.fixedLegDayCountConventions, &loaded.floatingLegDayCountConventions, &loaded.fixedLegPaymentFrequencies,
+		&loaded.floatingIndexes, &loaded.floatingIndexTenors, &loaded.currencies, &loaded.swapTypes, &loaded.swapLegTypes };
+	vector<int32_t>* ints[] = { &loaded.termYears, &loaded.effectiveDates, &loaded.terminationDates };
+	for (size_t i = 0; i < 8; i++) { LoadColumn(section, rows, *enums[i]); }
+	for (size_t i = 0; i < 3; i++) { LoadColumn(section, rows, *ints[i]); }
+	*this = move(loaded);
+}
+
+template<typename C>
+void IRSwapColumns::LoadColumn(SectionReader& section, size_t rows, vector<C>& column)
+{
+	size_t length;
+	const C* data = section.Array<C>(length);
+	if (length != rows) { throw runtime_error("Swap column section does not hold one row per swap"); }
+	column.assign(data, data + length);
+}
+
+IRSwapColumns::Conditions IRSwapColumns::Compile(const SwapFilter& filter) const
+{
+	Conditions conditions;
+	const int16_t values[] = { filter.fixedLegDayCountConvention, filter.floatingLegDayCountConvention, filter.fixedLegPaymentFrequency,
+		filter.floatingIndex, filter.floatingIndexTenor, filter.currency, filter.swapType, filter.swapLegType };
+	const vector<uint8_t>* columns[] = { &fixedLegDayCountConventions, &floatingLegDayCountConventions, &fixedLegPaymentFrequencies,
+		&floatingIndexes, &floatingIndexTenors, &currencies, &swapTypes, &swapLegTypes };
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+	{
+		if (values[i] == SwapFilter::ANY) { continue; }
+		ByteCondition condition = { columns[i]->data(), static_cast<uint8_t>(values[i]) };
+		conditions.bytes.push_back(condition);
+	}
+
+	const int32_t lows[] = { filter.minTermYears, filter.minEffectiveDate, filter.minTerminationDate };
+	const int32_t highs[] = { filter.maxTermYears, filter.maxEffectiveDate, filter.maxTerminationDate };
+	const vector<int32_t>* ranges[] = { &termYears, &effectiveDates, &terminationDates };
+	for (size_t i = 0; i < sizeof(lows) / sizeof(lows[0]); i++)
+	{
+		if (lows[i] == numeric_limits<int32_t>::min() && highs[i] == numeric_limits<int32_t>::max()) { continue; }
+		RangeCondition condition = { ranges[i]->data(), lows[i], highs[i] };
+		conditions.ranges.push_back(condition);
+	}
+	return conditions;
+}
+
+uint32_t IRSwapColumns::BlockMask(const Conditions& conditions, size_t first)
+{
+	uint32_t mask = 0xFFFFFFFFu;
+#if defined(__AVX2__)
+	for (vector<ByteCondition>::const_iterator it = conditions.bytes.begin(); it != conditions.bytes.end() && mask != 0; it++)
+	{
+		const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it->column + first));
+		const __m256i equal = _mm256_cmpeq_epi8(values, _mm256_set1_epi8(static_cast<char>(it->value)));
+		mask &= static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+	}
+	for (vector<RangeCondition>::const_iterator it = conditions.ranges.begin(); it != conditions.ranges.end() && mask != 0; it++)
+	{
+		const __m256i low = _mm256_set1_epi32(it->low);
+		const __m256i high = _mm256_set1_epi32(it->high);
+		uint32_t inRange = 0;
+		for (size_t lane = 0; lane < BlockRows; lane += 8)
+		{
+			const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it->column + first + lane));
+			const __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low, values), _mm256_cmpgt_epi32(values, high));
+			inRange |= static_cast<uint32_t>(~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF) << lane;
+		}
+		mask &= inRange;
+	}
+#elif defined(__SSE2__) || defined(_M_X64)
+	for (vector<ByteCondition>::const_iterator it = conditions.bytes.begin(); it != conditions.bytes.end() && mask != 0; it++)
+	{
+		const __m128i value = _mm_set1_epi8(static_cast<char>(it->value));
+		const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it->column + first));
+		const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it->column + first + 16));
+		mask &= static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, value)))
+			| static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, value))) << 16;
+	}
+	for (vector<RangeCondition>::const_iterator it = conditions.ranges.begin(); it != conditions.ranges.end() && mask != 0; it++)
+	{
+		const __m128i low = _mm_set1_epi32(it->low);
+		const __m128i high = _mm_set1_epi32(it->high);
+		uint32_t inRange = 0;
+		for (size_t lane = 0; lane < BlockRows; lane += 4)
+		{
+			const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it->column + first + lane));
+			const __m128i outside = _mm_or_si128(_mm_cmplt_epi32(values, low), _mm_cmpgt_epi32(values, high));
+			inRange |= static_cast<uint32_t>(~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF) << lane;
+		}
+		mask &= inRange;
+	}
+#else
+	for (vector<ByteCondition>::const_iterator it = conditions.bytes.begin(); it != conditions.bytes.end() && mask != 0; it++)
+	{
+		uint32_t equal = 0;
+		for (size_t i = 0; i < BlockRows; i++) { equal |= static_cast<uint32_t>(it->column[first + i] == it->value) << i; }
+		mask &= equal;
+	}
+	for (vector<RangeCondition>::const_iterator it = conditions.ranges.begin(); it != conditions.ranges.end() && mask != 0; it++)
+	{
+		uint32_t inRange = 0;
+		for (size_t i = 0; i < BlockRows; i++)
+		{
+			const int32_t value = it->column[first + i];
+			inRange |= static_cast<uint32_t>(value >= it->low && value <= it->high) << i;
+		}
+		mask &= inRange;
+	}
+#endif
+	return mask;
+}
+
+bool IRSwapColumns::RowMatches(const Conditions& conditions, size_t row)
+{
+	for (vector<ByteCondition>::const_iterator it = conditions.bytes.begin(); it != conditions.bytes.end(); it++)
+	{
+		if (it->column[row] != it->value) { return false; }
+	}
+	for (vector<RangeCondition>::const_iterator it = conditions.ranges.begin(); it != conditions.ranges.end(); it++)
+	{
+		if (it->column[row] < it->low || it->column[row] > it->high) { return false; }
+	}
+	return true;
+}
+
+template<typename F>
+void IRSwapColumns::Scan(const SwapFilter& filter, F f) const
+{
+	const Conditions conditions = Compile(filter);
+	const size_t rows = Size();
+	size_t first = 0;
+	for (; first + BlockRows <= rows; first += BlockRows)
+	{
+		for (uint32_t mask = BlockMask(conditions, first); mask != 0; mask &= mask - 1)
+		{
+			f(first + LowestBit(mask));
+		}
+	}
+	for (; first < rows; first++)
+	{
+		if (RowMatches(conditions, first)) { f(first); }
+	}
+}
+
+size_t IRSwapColumns::Count(const SwapFilter& filter) const
+{
+	const Conditions conditions = Compile(filter);
+	const size_t rows = Size();
+	size_t count = 0;
+	size_t first = 0;
+	for (; first + BlockRows <= rows; first += BlockRows) { count += BitCount(BlockMask(conditions, first)); }
+	for (; first < rows; first++) { count += RowMatches(conditions, first); }
+	return count;
+}
+
+Bitmap IRSwapColumns::Select(const SwapFilter& filter) const
+{
+	Bitmap rows;
+	Scan(filter, [&rows](size_t row) { rows.Add(static_cast<uint32_t>(row)); });
+	return rows;
+}
+
+#endif
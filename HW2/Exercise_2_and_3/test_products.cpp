@@ -5,6 +5,9 @@
 #include <iostream>
 #include "products.hpp"
 #include "productservice.hpp"
+#include "flatproducts.hpp"
+#include "productloader.hpp"
+#include "snapshot.hpp"
 
 using namespace std;
 
@@ -33,6 +36,17 @@ int main()
   bond = bondProductService->GetData(cusip2);
   cout << "CUSIP: " << bond.GetProductId() << " ==> " << bond << endl;
 
+  // Lookups by id never insert: Find and Contains report a miss, GetData throws
+  cout << "Contains " << cusip << ": " << bondProductService->Contains(cusip) << ", Find 000000000: " << (bondProductService->Find("000000000") == nullptr ? "none" : "found") << endl;
+  try
+  {
+    bondProductService->GetData("000000000");
+  }
+  catch (const out_of_range& e)
+  {
+    cout << "GetData: " << e.what() << endl;
+  }
+
   // Create the Spot 10Y Outright Swap
   date effectiveDate(2015, Nov, 16);
   date terminationDate(2025, Nov, 16);
@@ -66,6 +80,10 @@ int main()
   vector<Bond> vec1; string ticker = "T";
   vec1 = bondProductService->GetBonds(ticker);
   for (auto i = vec1.begin(); i != vec1.end(); i++) { cout << *i << endl; }
+  cout << "Number of Bonds per ticker:";
+  vector<pair<string, size_t> > tickerCounts = bondProductService->GetBondCountsByTicker();
+  for (auto i = tickerCounts.begin(); i != tickerCounts.end(); i++) { cout << " " << i->first << "=" << i->second; }
+  cout << endl;
   // Q3.2 Get all Swaps with the specified fixed leg day count convention
   cout << "Q3.2 Get all Swaps with the specified fixed leg day count convention" << endl;
   vector<IRSwap> vec2;
@@ -102,5 +120,94 @@ int main()
   vec8 = swapProductService->GetSwaps(OUTRIGHT);
   for (auto i = vec8.begin(); i != vec8.end(); i++) { cout << *i << endl; }
 
+  // Range queries on the sorted term and maturity indexes
+  cout << "Range queries" << endl;
+  cout << "Swaps with a term between 2 and 10 years, both included:" << endl;
+  vector<IRSwap> termRange = swapProductService->GetSwapsWithTermBetween(2, 10);
+  for (auto i = termRange.begin(); i != termRange.end(); i++) { cout << *i << endl; }
+  vector<vector<IRSwap> > termBuckets = swapProductService->GetSwapsByTermBuckets({ 2, 5, 10, 30 });
+  cout << "Swaps per term bucket 2y-5y-10y-30y: " << termBuckets[0].size() << " " << termBuckets[1].size() << " " << termBuckets[2].size() << endl;
+  cout << "Bonds maturing before 2020:" << endl;
+  vector<Bond> maturing = bondProductService->GetBondsMaturingBetween(date(2015, Jan, 1), date(2020, Jan, 1), true, false);
+  for (auto i = maturing.begin(); i != maturing.end(); i++) { cout << *i << endl; }
+
+  // Views iterate the matching products in place, without copying them
+  cout << "View of the Swaps with a term greater than 5 years:" << endl;
+  ProductView<IRSwap> longSwaps = swapProductService->ViewSwapsGreaterThan(5);
+  for (auto i = longSwaps.begin(); i != longSwaps.end(); i++) { cout << i->GetProductId() << endl; }
+
+  // Multi-predicate queries evaluated on the bitmap indexes
+  cout << "Multi-predicate queries" << endl;
+  cout << "USD 3mLIBOR Outright swaps longer than 5 years, not IMM:" << endl;
+  vector<const IRSwap*> matches = swapProductService->Query().WithCurrency(USD).WithFloatingIndex(LIBOR).WithFloatingIndexTenor(TENOR_3M)
+    .WithSwapLegType(OUTRIGHT).WithTermGreaterThan(5).Not().WithSwapType(IMM).Results();
+  for (auto i = matches.begin(); i != matches.end(); i++) { cout << **i << endl; }
+  cout << "Number of Spot or IMM swaps: " << swapProductService->Query().WithSwapType(SPOT).Or(swapProductService->Query().WithSwapType(IMM)).Count() << endl;
+  cout << "Number of CUSIP bonds with ticker T: " << bondProductService->Query().WithTicker("T").WithBondIdType(CUSIP).Count() << endl;
+
+  // Columnar scan: arbitrary conditions evaluated over packed attribute arrays
+  SwapFilter filter;
+  filter.currency = USD;
+  filter.floatingIndexTenor = TENOR_3M;
+  filter.minTermYears = 1;
+  filter.maxTermYears = 5;
+  filter.maxTerminationDate = ToDaySerial(date(2020, Jan, 1));
+  cout << "Columnar scan for USD 3M swaps of 1 to 5 years terminating before 2020:" << endl;
+  vector<const IRSwap*> scanned = swapProductService->ScanSwaps(filter);
+  for (auto i = scanned.begin(); i != scanned.end(); i++) { cout << (*i)->GetProductId() << endl; }
+
+  // Generic queries on the indexes declared by each ProductService, by getter
+  cout << "Generic indexed queries" << endl;
+  cout << "Number of USD swaps: " << swapProductService->Query().Where<&IRSwap::GetCurrency>(USD).Count() << endl;
+  FutureProductService futureProductService;
+  Future crudeFuture("CLZ5", COMMODITY, NYMEX, 1000, date(2025, Nov, 20));
+  BondFuture tenYearFuture("TYZ5", CBOT, 1000, date(2025, Dec, 19), 0.06f);
+  EuroDollarFuture eurodollarFuture("EDH6", CME, 2500, date(2026, Mar, 16), 0.0525f);
+  futureProductService.Add(crudeFuture);
+  futureProductService.Add(tenYearFuture);
+  futureProductService.Add(eurodollarFuture);
+  cout << "Futures not listed on NYMEX, maturing before 2026:" << endl;
+  futureProductService.Query().Not().Where<&Future::GetFutureExchange>(NYMEX).ForEach([](const Future& future) {
+    if (future.GetMaturityDate() < date(2026, Jan, 1)) { cout << future.GetProductId() << " " << future << endl; }
+  });
+
+  // Bulk loading: CSV lines parsed in parallel chunks (LoadBonds, LoadIRSwaps and LoadFutures map a whole file)
+  cout << "Bonds parsed from CSV" << endl;
+  vector<Bond> parsedBonds = ParseBonds("productId,bondIdType,ticker,coupon,maturityDate\n"
+                                        "912828U24,CUSIP,T,2.0,2026-11-15\n"
+                                        "US912810RZ30,ISIN,T,2.75,2046-11-15\n");
+  for (auto i = parsedBonds.begin(); i != parsedBonds.end(); i++) { bondProductService->Add(*i); }
+  cout << "Number of Bonds with ticker T: " << bondProductService->GetBondCount(ticker) << endl;
+  try
+  {
+    ParseFutures("ESZ5,EQUITY,CME,50,2025-12-19\nNQZ5,EQUITY,CME,twenty,2025-12-19\n");
+  }
+  catch (const invalid_argument& e)
+  {
+    cout << "ParseFutures: " << e.what() << endl;
+  }
+
+  // Binary snapshots: written atomically, opened in place by mapping the file, or restored into a service
+  cout << "Swap snapshot" << endl;
+  SaveSnapshot(*swapProductService, "swaps.snapshot");
+  {
+    ProductSnapshot<FlatIRSwap> snapshot("swaps.snapshot");
+    const FlatIRSwap* snapshotSwap = snapshot.Find(imm2Y);
+    cout << snapshot.Size() << " swaps, " << imm2Y << " in place: " << (snapshotSwap == nullptr ? "none" : FromFixedString(snapshotSwap->productId)) << endl;
+  }
+  IRSwapProductService restoredSwapProductService;
+  cout << "Restored " << RestoreSnapshot("swaps.snapshot", restoredSwapProductService) << " swaps: " << restoredSwapProductService.GetData(outright10Y) << endl;
+  remove("swaps.snapshot");
+
+  // Flat representations: fixed-size records that can be placed in shared memory and converted back
+  cout << "Flat representations of the products" << endl;
+  FlatBond flatBond = ToFlat(treasuryBond);
+  cout << "FlatBond (" << sizeof(FlatBond) << " bytes): " << FromFlat(flatBond) << endl;
+  FlatIRSwap flatSwap = ToFlat(outright10YSwap);
+  cout << "FlatIRSwap (" << sizeof(FlatIRSwap) << " bytes): " << FromFlat(flatSwap) << endl;
+  EuroDollarFuture euroDollarFuture("EDZ5", CME, 2500, date(2025, Dec, 15), 0.0525f);
+  FlatFuture flatFuture = ToFlat(euroDollarFuture);
+  cout << "FlatFuture (" << sizeof(FlatFuture) << " bytes): " << ToEuroDollarFuture(flatFuture) << endl;
+
   return 0;
 }